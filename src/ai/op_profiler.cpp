@@ -0,0 +1,79 @@
+#include "op_profiler.h"
+#include "profiler.h"
+#include "npu_hooks.h"
+#include <stdio.h>
+#include <string.h>
+
+extern "C" uint32_t SystemCoreClock;
+
+// 超出 OP_PROFILER_MAX_OPS 時的 handle (事件忽略)
+#define OP_PROFILER_INVALID_HANDLE 0xFFFFFFFFu
+
+OpProfiler::OpProfiler(const char* name)
+    : name_(name)
+    , num_ops_(0)
+    , invokes_(0)
+    , dropped_(0)
+{
+    memset(ops_, 0, sizeof(ops_));
+}
+
+int OpProfiler::findOrAdd(const char* tag) {
+    // tag 為 registration 內的常數字串，先比對指標再比對內容
+    for (int i = 0; i < num_ops_; i++) {
+        if (ops_[i].tag == tag || strcmp(ops_[i].tag, tag) == 0) {
+            return i;
+        }
+    }
+    
+    if (num_ops_ >= OP_PROFILER_MAX_OPS) return -1;
+    
+    ops_[num_ops_].tag = tag;
+    return num_ops_++;
+}
+
+uint32_t OpProfiler::BeginEvent(const char* tag) {
+    int idx = findOrAdd(tag ? tag : "?");
+    if (idx < 0) {
+        dropped_++;
+        return OP_PROFILER_INVALID_HANDLE;
+    }
+    
+    ops_[idx].idle_start = npu_idle_task_cycles();
+    ops_[idx].start = Profiler::now();
+    return (uint32_t)idx;
+}
+
+void OpProfiler::EndEvent(uint32_t event_handle) {
+    uint64_t end = Profiler::now();
+    if (event_handle == OP_PROFILER_INVALID_HANDLE) return;
+    
+    OpStats& op = ops_[event_handle];
+    op.cycles += (end - op.start) - (npu_idle_task_cycles() - op.idle_start);
+    op.count++;
+}
+
+void OpProfiler::printReport() const {
+    if (num_ops_ == 0 || invokes_ == 0) return;
+    
+    uint64_t total = 0;
+    for (int i = 0; i < num_ops_; i++) {
+        total += ops_[i].cycles;
+    }
+    
+    const float cycles_per_ms = SystemCoreClock / 1000.0f;
+    printf("[%s] Operator profile (%lu invokes):\n", name_, (unsigned long)invokes_);
+    printf("  %-24s %8s %10s %12s %7s\n", "op", "calls", "calls/inv", "ms/invoke", "share");
+    for (int i = 0; i < num_ops_; i++) {
+        const OpStats& op = ops_[i];
+        printf("  %-24s %8lu %10.1f %12.3f %6.1f%%\n",
+               op.tag, (unsigned long)op.count,
+               (float)op.count / invokes_,
+               op.cycles / cycles_per_ms / invokes_,
+               total > 0 ? 100.0f * op.cycles / total : 0.0f);
+    }
+    if (dropped_ > 0) {
+        printf("  (%lu events from more than %d op types not recorded)\n",
+               (unsigned long)dropped_, OP_PROFILER_MAX_OPS);
+    }
+}
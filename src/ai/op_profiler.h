@@ -0,0 +1,44 @@
+#ifndef OP_PROFILER_H
+#define OP_PROFILER_H
+
+#include <stdint.h>
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+
+// 可追蹤的運算子種類上限 (依 op 名稱彙總，同種 op 的多個節點合併)
+#define OP_PROFILER_MAX_OPS 24
+
+// TFLM 運算子層級的 profiler，傳給 MicroInterpreter 後每個節點的
+// Eval 都會呼叫 BeginEvent/EndEvent。以 op 名稱彙總整個執行期間的
+// cycles 與呼叫次數，用來確認哪些 op 落在 CPU 而非 Ethos-U。
+// NPU 等待期間執行的 CPU 工作 (npu_hooks idle task) 不計入該 op。
+class OpProfiler : public tflite::MicroProfilerInterface {
+public:
+    explicit OpProfiler(const char* name);
+    
+    uint32_t BeginEvent(const char* tag) override;
+    void EndEvent(uint32_t event_handle) override;
+    
+    // 每次 Invoke 結束後呼叫，用來計算每次 Invoke 的平均
+    void countInvoke() { invokes_++; }
+    
+    void printReport() const;
+    
+private:
+    struct OpStats {
+        const char* tag;
+        uint32_t count;
+        uint64_t cycles;
+        uint64_t start;
+        uint32_t idle_start;
+    };
+    
+    const char* name_;
+    OpStats ops_[OP_PROFILER_MAX_OPS];
+    int num_ops_;
+    uint32_t invokes_;
+    uint32_t dropped_;
+    
+    int findOrAdd(const char* tag);
+};
+
+#endif // OP_PROFILER_H
@@ -1,12 +1,20 @@
 #include "reid.h"
+#include "assignment.h"
 #include "image_utils.h"
+#include "npu_hooks.h"
+#include "profiler.h"
+#include "op_profiler.h"
+#include "tensor_arena.h"
+#include "mem_placement.h"
 #include <stdio.h>
 #include <string.h>
 #include <cmath>
+#include <algorithm>
 
 extern "C" uint32_t SystemCoreClock;
 
 #include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -15,22 +23,47 @@ extern TFLMRegistration* Register_ETHOSU();
 extern const char* GetString_ETHOSU();
 }
 
-#define REID_TENSOR_ARENA_SIZE (2 * 1024 * 1024)  // 2MB
-static uint8_t reid_tensor_arena[REID_TENSOR_ARENA_SIZE] __attribute__((section(".ddr_data"), aligned(16)));
+#if !TENSOR_ARENA_SHARED
+static uint8_t reid_tensor_arena[REID_TENSOR_ARENA_SIZE] MEM_PLACE(MEM_PLACE_TENSOR_ARENA);
+#endif
 
-ReIDMatcher::ReIDMatcher(float similarity_threshold)
+// 運算子層級 profiler (APP_PROFILING 關閉時不掛到 interpreter)
+static OpProfiler reid_op_profiler("ReID");
+
+// 整幀匹配的相似度矩陣與指派成本矩陣 (多出的欄代表「新人物」)
+static float reid_match_similarity[REID_GALLERY_MAX_QUERIES * REID_GALLERY_MAX_COLUMNS] MEM_PLACE(MEM_PLACE_GALLERY);
+static_assert(REID_GALLERY_MAX_QUERIES <= ASSIGNMENT_MAX_SHORT &&
+              REID_GALLERY_MAX_COLUMNS + REID_GALLERY_MAX_QUERIES <= ASSIGNMENT_MAX_DIM,
+              "Frame matching exceeds assignment solver limits");
+static float reid_match_cost[REID_GALLERY_MAX_QUERIES * (REID_GALLERY_MAX_COLUMNS + REID_GALLERY_MAX_QUERIES)] MEM_PLACE(MEM_PLACE_GALLERY);
+
+static int8_t reid_staging_buffer[REID_INPUT_WIDTH * REID_INPUT_HEIGHT * 3] __attribute__((section(".ddr_data"), aligned(16)));
+
+// uint8 像素 -> int8 輸入的查表 (crop 縮放時每個像素查一次)
+static int8_t reid_input_lut[256] MEM_PLACE(MEM_PLACE_LUTS);
+
+ReIDMatcher::ReIDMatcher(float similarity_threshold, size_t gallery_budget)
     : interpreter_(nullptr)
     , input_tensor_(nullptr)
     , output_tensor_(nullptr)
     , tensor_arena_(nullptr)
-    , gallery_count_(0)
+    , gallery_budget_(gallery_budget)
     , next_person_id_(0)
     , similarity_threshold_(similarity_threshold)
     , total_inferences_(0)
     , total_inference_time_(0.0f)
+    , total_overlapped_(0)
+    , npu_pmu_()
+    , input_lut_(nullptr)
+    , staging_roi_(nullptr)
+    , staging_buffer_(nullptr)
 {
+#if !TENSOR_ARENA_SHARED
     tensor_arena_ = reid_tensor_arena;
-    memset(gallery_, 0, sizeof(gallery_));
+#endif
+    staging_buffer_ = reid_staging_buffer;
+    input_lut_ = reid_input_lut;
+    memset(reid_input_lut, 0, sizeof(reid_input_lut));
 }
 
 ReIDMatcher::~ReIDMatcher() {
@@ -61,10 +94,30 @@ bool ReIDMatcher::init(const void* model_data, size_t model_size) {
     micro_op_resolver.AddSoftmax();
     micro_op_resolver.AddL2Normalization();
     
+#if TENSOR_ARENA_SHARED
+    // activation 區域與 YOLO 共用: 特徵在下一次 YOLO Invoke 前已取出
+    auto* allocator = (tflite::MicroAllocator*)TensorArena::createAllocator(TENSOR_ARENA_REID);
+    if (allocator == nullptr) {
+        printf("[ReID] Failed to create tensor allocator\n");
+        return false;
+    }
+    static tflite::MicroInterpreter static_interpreter(
+        model, micro_op_resolver, allocator, nullptr,
+        APP_PROFILING ? &reid_op_profiler : nullptr
+    );
+    const size_t arena_reserved = TENSOR_ARENA_SHARED_SIZE + REID_PERSISTENT_ARENA_SIZE;
+#else
     static tflite::MicroInterpreter static_interpreter(
         model, micro_op_resolver, tensor_arena_,
-        REID_TENSOR_ARENA_SIZE
+        REID_TENSOR_ARENA_SIZE, nullptr,
+        APP_PROFILING ? &reid_op_profiler : nullptr
     );
+    const size_t arena_reserved = REID_TENSOR_ARENA_SIZE;
+    MemPlacement::record("ReID tensor arena", reid_tensor_arena, sizeof(reid_tensor_arena));
+#endif
+    MemPlacement::record("ReID input LUT", reid_input_lut, sizeof(reid_input_lut));
+    MemPlacement::record("ReID match similarity", reid_match_similarity, sizeof(reid_match_similarity));
+    MemPlacement::record("ReID match cost", reid_match_cost, sizeof(reid_match_cost));
     
     auto* interpreter = &static_interpreter;
     
@@ -72,6 +125,7 @@ bool ReIDMatcher::init(const void* model_data, size_t model_size) {
         printf("[ReID] AllocateTensors failed\n");
         return false;
     }
+    TensorArena::recordUsage(TENSOR_ARENA_REID, interpreter->arena_used_bytes(), arena_reserved);
     
     interpreter_ = (void*)interpreter;
     input_tensor_ = (void*)interpreter->input(0);
@@ -85,26 +139,47 @@ bool ReIDMatcher::init(const void* model_data, size_t model_size) {
            input->dims->data[1], input->dims->data[2], input->dims->data[3]);
     printf("[ReID] Output feature dim: %d\n", output->dims->data[1]);
     
+    if (!initInputLUT()) {
+        return false;
+    }
+    
+    if (!gallery_.init(gallery_budget_)) {
+        return false;
+    }
+    gallery_.setBorderlineBand(similarity_threshold_ - REID_BORDERLINE_MARGIN,
+                               similarity_threshold_ + REID_BORDERLINE_MARGIN);
+    
     return true;
 }
 
-void ReIDMatcher::preprocessImage(const uint8_t* image, int width, int height) {
+bool ReIDMatcher::initInputLUT() {
     auto* input = (TfLiteTensor*)input_tensor_;
-    int8_t* input_data = input->data.int8;
+    float scale = input->params.scale;
+    int32_t zero_point = input->params.zero_point;
     
-    // Resize
-    uint8_t* resized = new uint8_t[REID_INPUT_WIDTH * REID_INPUT_HEIGHT * 3];
+    if (scale <= 0.0f) {
+        printf("[ReID] Invalid input scale %f\n", scale);
+        return false;
+    }
     
-    ImageUtils::resize(image, width, height,
-                      resized, REID_INPUT_WIDTH, REID_INPUT_HEIGHT);
+    ImageUtils::buildNormalizeLUT(scale, zero_point, input_lut_);
     
-    // Normalize
-    for (int i = 0; i < REID_INPUT_WIDTH * REID_INPUT_HEIGHT * 3; i++) {
-        float normalized = (resized[i] / 255.0f - 0.5f) * 2.0f;
-        input_data[i] = (int8_t)(normalized * 127.0f);
-    }
+    printf("[ReID] Input quant: scale=%f zp=%ld\n", scale, (long)zero_point);
+    return true;
+}
+
+void ReIDMatcher::preprocessImage(const ImageView& roi, int8_t* dst) {
+    PROFILE_SCOPE(PROF_REID_PREPROCESS);
     
-    delete[] resized;
+    // 從 ROI 最近鄰取樣並查表正規化，直接寫入目的緩衝區 (單一 pass)
+    ImageUtils::resizeWithLUT(roi, dst, REID_INPUT_WIDTH, REID_INPUT_HEIGHT, input_lut_);
+}
+
+void ReIDMatcher::stagePendingInput(void* ctx) {
+    auto* self = (ReIDMatcher*)ctx;
+    if (self->staging_roi_) {
+        self->preprocessImage(*self->staging_roi_, self->staging_buffer_);
+    }
 }
 
 void ReIDMatcher::extractAndNormalize(float* features) {
@@ -130,18 +205,74 @@ void ReIDMatcher::extractAndNormalize(float* features) {
 }
 
 bool ReIDMatcher::extractFeatures(const uint8_t* person_image, int width, int height, float* features) {
-    auto* interpreter = (tflite::MicroInterpreter*)interpreter_;
+    ImageView roi = {person_image, width * 3, 0, 0, width, height};
+    return extractFeatures(roi, features);
+}
+
+bool ReIDMatcher::extractFeatures(const ImageView& roi, float* features) {
+    auto* input = (TfLiteTensor*)input_tensor_;
     
     // Preprocess
-    preprocessImage(person_image, width, height);
+    preprocessImage(roi, input->data.int8);
+    
+    return runInference(features);
+}
+
+int ReIDMatcher::extractFeaturesBatch(const ImageView* rois, int count,
+                                      float (*features)[REID_FEATURE_DIM], bool* valid) {
+    if (count <= 0) return 0;
+    
+    PROFILE_SCOPE(PROF_REID);
+    auto* input = (TfLiteTensor*)input_tensor_;
+    const size_t input_bytes = REID_INPUT_WIDTH * REID_INPUT_HEIGHT * 3;
+    int num_valid = 0;
+    
+    // 第一個人物無法重疊，直接前處理
+    preprocessImage(rois[0], input->data.int8);
+    
+    for (int i = 0; i < count; i++) {
+        bool has_next = (i + 1 < count);
+        
+        // NPU 推論期間於 CPU 準備下一個人物 (不能直接寫入仍在使用中的輸入張量)
+        if (has_next) {
+            staging_roi_ = &rois[i + 1];
+            npu_set_idle_task(stagePendingInput, this);
+        }
+        
+        valid[i] = runInference(features[i]);
+        if (valid[i]) num_valid++;
+        
+        if (has_next) {
+            // Invoke 未進入等待 (例如失敗) 時補做前處理
+            if (npu_clear_idle_task()) {
+                total_overlapped_++;
+            } else {
+                preprocessImage(rois[i + 1], staging_buffer_);
+            }
+            staging_roi_ = nullptr;
+            memcpy(input->data.int8, staging_buffer_, input_bytes);
+        }
+    }
+    
+    return num_valid;
+}
+
+bool ReIDMatcher::runInference(float* features) {
+    auto* interpreter = (tflite::MicroInterpreter*)interpreter_;
     
     // Inference
     uint32_t start = get_cycle_count();
+    uint32_t idle_start = npu_idle_task_cycles();
     
     TfLiteStatus invoke_status = interpreter->Invoke();
     
+    // 扣除 NPU 等待期間執行的 CPU 工作 (管線模式)
     uint32_t end = get_cycle_count();
-    float inference_ms = (end - start) / (float)(SystemCoreClock / 1000);
+    uint32_t busy = (end - start) - (npu_idle_task_cycles() - idle_start);
+    float inference_ms = busy / (float)(SystemCoreClock / 1000);
+    PROFILE_RECORD(PROF_REID_INVOKE, busy);
+    reid_op_profiler.countInvoke();
+    npu_pmu_collect(&npu_pmu_);
     
     total_inferences_++;
     total_inference_time_ += inference_ms;
@@ -159,68 +290,123 @@ bool ReIDMatcher::extractFeatures(const uint8_t* person_image, int width, int he
     return true;
 }
 
-float ReIDMatcher::computeSimilarity(const float* feat1, const float* feat2) const {
-    float similarity = 0.0f;
-    for (int i = 0; i < REID_FEATURE_DIM; i++) {
-        similarity += feat1[i] * feat2[i];
+int ReIDMatcher::matchFrame(const float (*features)[REID_FEATURE_DIM], const bool* valid, int count,
+                            uint32_t current_frame, int* person_ids,
+                            const int* held_ids, int num_held) {
+    const float* queries[REID_GALLERY_MAX_QUERIES];
+    int query_index[REID_GALLERY_MAX_QUERIES];
+    int assigned[REID_GALLERY_MAX_QUERIES];
+    int columns[REID_GALLERY_MAX_COLUMNS];
+    int held_slots[REID_GALLERY_MAX_QUERIES];
+    
+    // 追蹤沿用的 ID 本幀確實出現: 更新 last_seen，避免被當作久未出現而淘汰
+    int num_held_slots = 0;
+    for (int h = 0; h < num_held && num_held_slots < REID_GALLERY_MAX_QUERIES; h++) {
+        int slot = gallery_.findPerson(held_ids[h]);
+        if (slot < 0) continue;
+        gallery_.touch(slot, current_frame);
+        held_slots[num_held_slots++] = slot;
     }
-    return similarity;
-}
-
-int ReIDMatcher::matchInGallery(const float* features, uint32_t current_frame) {
-    int best_match = -1;
-    float best_similarity = similarity_threshold_;
     
-    for (int i = 0; i < gallery_count_; i++) {
-        float similarity = computeSimilarity(features, gallery_[i].features);
-        
-        if (similarity > best_similarity) {
-            best_similarity = similarity;
-            best_match = i;
+    int num_queries = 0;
+    for (int i = 0; i < count; i++) {
+        person_ids[i] = -1;
+        if (valid[i] && num_queries < REID_GALLERY_MAX_QUERIES) {
+            queries[num_queries] = features[i];
+            query_index[num_queries] = i;
+            num_queries++;
         }
     }
+    if (num_queries == 0) return 0;
     
-    if (best_match >= 0) {
-        gallery_[best_match].last_seen_frame = current_frame;
+    // Step 1: 一次計算相似度矩陣
+    int num_columns = gallery_.buildSimilarityMatrix(queries, num_queries, columns,
+                                                     REID_GALLERY_MAX_COLUMNS, reid_match_similarity);
+    
+    // 已由追蹤沿用的 ID 不能再指派給其他查詢 (同一幀不會有兩個人物得到相同 ID)
+    for (int c = 0; c < num_columns; c++) {
+        bool held = false;
+        for (int h = 0; h < num_held_slots; h++) {
+            if (columns[c] == held_slots[h]) held = true;
+        }
+        if (!held) continue;
+        for (int q = 0; q < num_queries; q++) {
+            reid_match_similarity[q * num_columns + c] = -1.0f;
+        }
+    }
+    
+    // Step 2: 成本 = -相似度；每列另有「新人物」欄，成本為 -threshold
+    // 相似度不超過閾值時，指派到新人物欄不會比較差
+    int cost_cols = num_columns + num_queries;
+    for (int q = 0; q < num_queries; q++) {
+        float* row = reid_match_cost + q * cost_cols;
+        for (int c = 0; c < num_columns; c++) {
+            row[c] = -reid_match_similarity[q * num_columns + c];
+        }
+        for (int c = num_columns; c < cost_cols; c++) {
+            row[c] = -similarity_threshold_;
+        }
+    }
+    Assignment::solveMin(reid_match_cost, num_queries, cost_cols, assigned);
+    
+    // Step 3: 先套用所有匹配，再加入新人物 (避免新加入者影響同幀匹配)
+    int num_matched = 0;
+    for (int q = 0; q < num_queries; q++) {
+        int c = assigned[q];
+        if (c < 0 || c >= num_columns) continue;
+        float similarity = reid_match_similarity[q * num_columns + c];
+        if (similarity <= similarity_threshold_) continue;
+        int slot = columns[c];
+        gallery_.update(slot, queries[q], current_frame);
+        person_ids[query_index[q]] = gallery_.personId(slot);
         printf("[ReID] Matched Person ID %d (similarity: %.3f)\n",
-               gallery_[best_match].person_id, best_similarity);
-        return gallery_[best_match].person_id;
+               gallery_.personId(slot), similarity);
+        num_matched++;
+    }
+    for (int q = 0; q < num_queries; q++) {
+        if (person_ids[query_index[q]] < 0) {
+            person_ids[query_index[q]] = addToGallery(queries[q], current_frame);
+        }
     }
     
-    return -1;
+    return num_matched;
 }
 
 int ReIDMatcher::addToGallery(const float* features, uint32_t current_frame) {
-    if (gallery_count_ >= MAX_GALLERY_SIZE) {
-        // Find oldest entry
-        uint32_t oldest_frame = gallery_[0].last_seen_frame;
-        int oldest_idx = 0;
-        
-        for (int i = 1; i < gallery_count_; i++) {
-            if (gallery_[i].last_seen_frame < oldest_frame) {
-                oldest_frame = gallery_[i].last_seen_frame;
-                oldest_idx = i;
-            }
-        }
-        
-        // Replace oldest
-        memcpy(gallery_[oldest_idx].features, features, REID_FEATURE_DIM * sizeof(float));
-        gallery_[oldest_idx].person_id = next_person_id_++;
-        gallery_[oldest_idx].last_seen_frame = current_frame;
-        
-        printf("[ReID] Gallery full, replaced ID %d with new Person ID %d\n",
-               oldest_idx, gallery_[oldest_idx].person_id);
-        return gallery_[oldest_idx].person_id;
+    int person_id = next_person_id_++;
+    int evicted_id = -1;
+    
+    if (gallery_.add(features, person_id, current_frame, &evicted_id) < 0) {
+        printf("[ReID] Gallery unavailable, Person ID %d not stored\n", person_id);
+        return person_id;
     }
     
-    // Add new person
-    memcpy(gallery_[gallery_count_].features, features, REID_FEATURE_DIM * sizeof(float));
-    gallery_[gallery_count_].person_id = next_person_id_++;
-    gallery_[gallery_count_].last_seen_frame = current_frame;
+    if (evicted_id >= 0) {
+        printf("[ReID] Gallery full, replaced ID %d with new Person ID %d\n",
+               evicted_id, person_id);
+    } else {
+        printf("[ReID] Added new Person ID %d to gallery\n", person_id);
+    }
     
-    printf("[ReID] Added new Person ID %d to gallery\n", gallery_[gallery_count_].person_id);
+    return person_id;
+}
+
+bool ReIDMatcher::saveGallery(const char* path, bool store_int8) const {
+    return gallery_.save(path, next_person_id_, store_int8);
+}
+
+bool ReIDMatcher::loadGallery(const char* path) {
+    int32_t next_id = 0;
+    if (!gallery_.load(path, &next_id)) {
+        return false;
+    }
     
-    return gallery_[gallery_count_++].person_id;
+    // 確保新 ID 不與載入的 ID 重複
+    for (int i = 0; i < gallery_.size(); i++) {
+        if (gallery_.personId(i) >= next_id) next_id = gallery_.personId(i) + 1;
+    }
+    next_person_id_ = next_id;
+    return true;
 }
 
 void ReIDMatcher::printStats() const {
@@ -228,14 +414,32 @@ void ReIDMatcher::printStats() const {
         printf("[ReID] Statistics:\n");
         printf("  Total inferences: %d\n", total_inferences_);
         printf("  Average time: %.2f ms\n", total_inference_time_ / total_inferences_);
-        printf("  Gallery size: %d/%d\n", gallery_count_, MAX_GALLERY_SIZE);
+        printf("  Preprocess overlapped with NPU: %d\n", total_overlapped_);
+        npu_pmu_print(npu_pmu_, total_inferences_, total_inference_time_ / total_inferences_);
+        reid_op_profiler.printReport();
+        printf("  Gallery size: %d/%d (%u bytes/entry)\n", gallery_.size(), gallery_.capacity(),
+               (unsigned)ReIDGallery::bytesPerEntry());
+        if (gallery_.searchCount() > 0) {
+            printf("  Avg candidates rescored: %.1f\n",
+                   (float)gallery_.rescoredCount() / gallery_.searchCount());
+            printf("  Borderline exemplar checks: %lu\n",
+                   (unsigned long)gallery_.exemplarCheckCount());
+        }
     }
 }
 
+// printGallery 最多列出的筆數 (大型 gallery 只顯示開頭)
+#define REID_PRINT_GALLERY_LIMIT 50
+
 void ReIDMatcher::printGallery() const {
-    printf("[ReID] Gallery (%d persons):\n", gallery_count_);
-    for (int i = 0; i < gallery_count_; i++) {
+    int count = gallery_.size();
+    printf("[ReID] Gallery (%d persons):\n", count);
+    int shown = std::min(count, REID_PRINT_GALLERY_LIMIT);
+    for (int i = 0; i < shown; i++) {
         printf("  [%d] Person ID: %d, Last seen: frame %lu\n",
-               i, gallery_[i].person_id, gallery_[i].last_seen_frame);
+               i, gallery_.personId(i), (unsigned long)gallery_.lastSeen(i));
     }
-}
\ No newline at end of file
+    if (count > shown) {
+        printf("  ... (%d more)\n", count - shown);
+    }
+}
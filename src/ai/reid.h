@@ -4,21 +4,24 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <vector>
+#include "image_utils.h"
+#include "reid_gallery.h"
+#include "npu_pmu.h"
 
 #define REID_INPUT_WIDTH  128
 #define REID_INPUT_HEIGHT 256
-#define REID_FEATURE_DIM  512
-#define MAX_GALLERY_SIZE  20
 
-struct PersonFeature {
-    float features[REID_FEATURE_DIM];
-    int person_id;
-    uint32_t last_seen_frame;
-};
+// int8 相似度相對 float 參考的容許誤差 (tests/test_reid_kernels.cpp 驗證)
+#define REID_INT8_SIMILARITY_TOLERANCE 0.01f
+
+// 模板相似度在 threshold ± margin 內時另外比對 gallery 樣本
+#define REID_BORDERLINE_MARGIN 0.1f
 
 class ReIDMatcher {
 public:
-    ReIDMatcher(float similarity_threshold = 0.6f);
+    // gallery_budget: Gallery 可使用的記憶體 (bytes)，決定可容納的人數
+    ReIDMatcher(float similarity_threshold = 0.6f,
+                size_t gallery_budget = REID_GALLERY_POOL_SIZE);
     ~ReIDMatcher();
     
     bool init(const void* model_data, size_t model_size);
@@ -26,14 +29,33 @@ public:
     // 提取特徵
     bool extractFeatures(const uint8_t* person_image, int width, int height, float* features);
     
-    // 在 Gallery 中匹配
-    int matchInGallery(const float* features, uint32_t current_frame);
+    // 直接從原始影像的 ROI 提取特徵 (不需先裁切)
+    bool extractFeatures(const ImageView& roi, float* features);
+    
+    // 批次提取一幀中所有人物的特徵
+    // NPU 推論第 i 個人物時，CPU 同時準備第 i+1 個人物的輸入
+    // valid[i] 表示第 i 個特徵是否成功，回傳成功的數量
+    int extractFeaturesBatch(const ImageView* rois, int count,
+                             float (*features)[REID_FEATURE_DIM], bool* valid);
+    
+    // 整幀匹配: 建立 (偵測 x gallery) 相似度矩陣後求一對一最佳指派
+    // 同一幀中不會有兩個人物得到相同 ID，未匹配者加入 Gallery
+    // person_ids[i] 為第 i 個特徵的 ID (valid[i] 為 false 時為 -1)，回傳匹配到既有 ID 的數量
+    // held_ids: 本幀由追蹤沿用的 ID，不參與指派，只更新其 last_seen
+    int matchFrame(const float (*features)[REID_FEATURE_DIM], const bool* valid, int count,
+                   uint32_t current_frame, int* person_ids,
+                   const int* held_ids = nullptr, int num_held = 0);
     
     // 加入新人到 Gallery
     int addToGallery(const float* features, uint32_t current_frame);
     
+    // Gallery 存檔 / 載入 (semihosting 檔案)，載入後延續 person ID 編號
+    bool saveGallery(const char* path, bool store_int8 = true) const;
+    bool loadGallery(const char* path);
+    
     // 獲取 Gallery 大小
-    int getGallerySize() const { return gallery_count_; }
+    int getGallerySize() const { return gallery_.size(); }
+    int getGalleryCapacity() const { return gallery_.capacity(); }
     
     void printStats() const;
     void printGallery() const;
@@ -44,17 +66,29 @@ private:
     void* output_tensor_;
     uint8_t* tensor_arena_;
     
-    PersonFeature gallery_[MAX_GALLERY_SIZE];
-    int gallery_count_;
+    ReIDGallery gallery_;
+    size_t gallery_budget_;
     int next_person_id_;
     float similarity_threshold_;
     
     int total_inferences_;
     float total_inference_time_;
+    int total_overlapped_;     // 與 NPU 推論重疊完成的前處理次數
+    NpuPmuCounters npu_pmu_;   // NPU_PMU_CAPTURE 開啟時累計
+    
+    // uint8 像素 -> int8 輸入的查表 (依輸入張量的 scale / zero_point 建立，
+    // 指向靜態表，位置由 MEM_PLACE_LUTS 決定)
+    int8_t* input_lut_;
+    
+    // 批次前處理的暫存狀態
+    const ImageView* staging_roi_;
+    int8_t* staging_buffer_;
     
-    void preprocessImage(const uint8_t* image, int width, int height);
+    bool initInputLUT();
+    void preprocessImage(const ImageView& roi, int8_t* dst);
+    bool runInference(float* features);
+    static void stagePendingInput(void* ctx);
     void extractAndNormalize(float* features);
-    float computeSimilarity(const float* feat1, const float* feat2) const;
 };
 
 #endif // REID_H
\ No newline at end of file
@@ -0,0 +1,574 @@
+#include "reid_gallery.h"
+#include "reid_kernels.h"
+#include "mem_placement.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static uint8_t reid_gallery_pool[REID_GALLERY_POOL_SIZE] MEM_PLACE(MEM_PLACE_GALLERY);
+
+// 隨機投影矩陣 (±1)，每列對應簽章的一個位元
+static int8_t reid_projection[REID_GALLERY_SIGNATURE_BITS][REID_FEATURE_DIM] MEM_PLACE(MEM_PLACE_LUTS);
+
+// 批次匹配時量化後的查詢
+static int8_t batch_queries_q[REID_GALLERY_MAX_QUERIES][REID_FEATURE_DIM] MEM_PLACE(MEM_PLACE_GALLERY);
+static float batch_scales[REID_GALLERY_MAX_QUERIES];
+
+// 浮點 / int8 暫存 (EMA 更新、存檔格式轉換)
+static float float_scratch[REID_FEATURE_DIM];
+static int8_t io_scratch_q[REID_FEATURE_DIM];
+
+static_assert(sizeof(ReIDGalleryFileHeader) == 24, "Gallery file header layout changed");
+static_assert(sizeof(ReIDGalleryFileRecord) == 12, "Gallery file record layout changed");
+
+// pool 切割時每個陣列的對齊
+#define REID_GALLERY_ALIGN 16
+
+static uint8_t* carve(uint8_t*& cursor, size_t bytes) {
+    uint8_t* ptr = cursor;
+    cursor += (bytes + REID_GALLERY_ALIGN - 1) & ~(size_t)(REID_GALLERY_ALIGN - 1);
+    return ptr;
+}
+
+ReIDGallery::ReIDGallery()
+    : capacity_(0)
+    , count_(0)
+    , exemplar_count_(nullptr)
+    , exemplar_next_(nullptr)
+    , signatures_(nullptr)
+    , person_ids_(nullptr)
+    , last_seen_(nullptr)
+    , distances_(nullptr)
+    , column_marks_(nullptr)
+    , query_scale_(0.0f)
+    , borderline_low_(0.0f)
+    , borderline_high_(0.0f)
+    , total_searches_(0)
+    , total_rescored_(0)
+    , total_exemplar_checks_(0)
+{
+    memset(&templates_, 0, sizeof(templates_));
+    memset(&exemplars_, 0, sizeof(exemplars_));
+    memset(candidates_, 0, sizeof(candidates_));
+    memset(query_q_, 0, sizeof(query_q_));
+}
+
+size_t ReIDGallery::bytesPerEntry() {
+#if REID_GALLERY_INT8
+    size_t vector_bytes = REID_FEATURE_DIM * sizeof(int8_t) + sizeof(float);
+#else
+    size_t vector_bytes = REID_FEATURE_DIM * sizeof(float);
+#endif
+    // 模板 + 樣本、簽章、id、last_seen、距離/去重暫存、樣本數/ring 位置
+    return vector_bytes * (1 + REID_GALLERY_EXEMPLARS) + sizeof(ReIDSignature) +
+           sizeof(int32_t) + sizeof(uint32_t) + 4 * sizeof(uint8_t);
+}
+
+bool ReIDGallery::init(size_t budget_bytes) {
+    if (budget_bytes > REID_GALLERY_POOL_SIZE) {
+        printf("[ReID] Gallery budget %u exceeds pool %u, clamping\n",
+               (unsigned)budget_bytes, (unsigned)REID_GALLERY_POOL_SIZE);
+        budget_bytes = REID_GALLERY_POOL_SIZE;
+    }
+    
+    // 保留每個陣列的對齊餘量
+    const size_t align_slack = 12 * REID_GALLERY_ALIGN;
+    if (budget_bytes <= align_slack) {
+        printf("[ReID] Gallery budget too small\n");
+        return false;
+    }
+    capacity_ = (int)((budget_bytes - align_slack) / bytesPerEntry());
+    count_ = 0;
+    if (capacity_ <= 0) {
+        printf("[ReID] Gallery budget too small\n");
+        return false;
+    }
+    
+    uint8_t* cursor = reid_gallery_pool;
+    const size_t num_exemplars = (size_t)capacity_ * REID_GALLERY_EXEMPLARS;
+#if REID_GALLERY_INT8
+    templates_.data = (int8_t*)carve(cursor, (size_t)capacity_ * REID_FEATURE_DIM * sizeof(int8_t));
+    templates_.scales = (float*)carve(cursor, capacity_ * sizeof(float));
+    exemplars_.data = (int8_t*)carve(cursor, num_exemplars * REID_FEATURE_DIM * sizeof(int8_t));
+    exemplars_.scales = (float*)carve(cursor, num_exemplars * sizeof(float));
+#else
+    templates_.data = (float*)carve(cursor, (size_t)capacity_ * REID_FEATURE_DIM * sizeof(float));
+    exemplars_.data = (float*)carve(cursor, num_exemplars * REID_FEATURE_DIM * sizeof(float));
+#endif
+    exemplar_count_ = carve(cursor, capacity_ * sizeof(uint8_t));
+    exemplar_next_ = carve(cursor, capacity_ * sizeof(uint8_t));
+    signatures_ = (ReIDSignature*)carve(cursor, capacity_ * sizeof(ReIDSignature));
+    person_ids_ = (int32_t*)carve(cursor, capacity_ * sizeof(int32_t));
+    last_seen_ = (uint32_t*)carve(cursor, capacity_ * sizeof(uint32_t));
+    distances_ = carve(cursor, capacity_ * sizeof(uint8_t));
+    column_marks_ = carve(cursor, capacity_ * sizeof(uint8_t));
+    memset(column_marks_, 0, capacity_);
+    
+    initProjection();
+    
+    MemPlacement::record("ReID gallery pool", reid_gallery_pool, sizeof(reid_gallery_pool));
+    MemPlacement::record("ReID gallery projection", reid_projection, sizeof(reid_projection));
+    MemPlacement::record("ReID batch queries", batch_queries_q, sizeof(batch_queries_q));
+    
+    printf("[ReID] Gallery: capacity %d (%u bytes/entry, %d exemplars, %u bytes used)\n",
+           capacity_, (unsigned)bytesPerEntry(), REID_GALLERY_EXEMPLARS,
+           (unsigned)(cursor - reid_gallery_pool));
+    return true;
+}
+
+void ReIDGallery::initProjection() {
+    // 固定種子的 LCG，保證每次啟動 (及存檔/載入) 的簽章一致
+    uint32_t state = 0x9E3779B9u;
+    for (int b = 0; b < REID_GALLERY_SIGNATURE_BITS; b++) {
+        for (int i = 0; i < REID_FEATURE_DIM; i++) {
+            state = state * 1664525u + 1013904223u;
+            reid_projection[b][i] = (state & 0x80000000u) ? 1 : -1;
+        }
+    }
+}
+
+ReIDSignature ReIDGallery::computeSignature(const int8_t* features_q) const {
+    ReIDSignature signature;
+    memset(&signature, 0, sizeof(signature));
+    for (int b = 0; b < REID_GALLERY_SIGNATURE_BITS; b++) {
+        if (ReIDKernels::dotInt8(reid_projection[b], features_q, REID_FEATURE_DIM) >= 0) {
+            signature.words[b / 64] |= (uint64_t)1 << (b % 64);
+        }
+    }
+    return signature;
+}
+
+static inline int hammingDistance(const ReIDSignature& a, const ReIDSignature& b) {
+    int d = 0;
+    for (int w = 0; w < REID_GALLERY_SIGNATURE_WORDS; w++) {
+        d += __builtin_popcountll(a.words[w] ^ b.words[w]);
+    }
+    return d;
+}
+
+void ReIDGallery::writeVector(ReIDFeatureArray& array, size_t index, const float* features,
+                              const int8_t* features_q, float scale) {
+#if REID_GALLERY_INT8
+    (void)features;
+    memcpy(array.data + index * REID_FEATURE_DIM, features_q, REID_FEATURE_DIM);
+    array.scales[index] = scale;
+#else
+    (void)features_q;
+    (void)scale;
+    memcpy(array.data + index * REID_FEATURE_DIM, features, REID_FEATURE_DIM * sizeof(float));
+#endif
+}
+
+void ReIDGallery::readVector(const ReIDFeatureArray& array, size_t index, float* out) {
+#if REID_GALLERY_INT8
+    const int8_t* src = array.data + index * REID_FEATURE_DIM;
+    float scale = array.scales[index];
+    for (int i = 0; i < REID_FEATURE_DIM; i++) out[i] = src[i] * scale;
+#else
+    memcpy(out, array.data + index * REID_FEATURE_DIM, REID_FEATURE_DIM * sizeof(float));
+#endif
+}
+
+float ReIDGallery::vectorSimilarity(const ReIDFeatureArray& array, size_t index, const float* features,
+                                    const int8_t* features_q, float scale) {
+#if REID_GALLERY_INT8
+    (void)features;
+    int32_t dot = ReIDKernels::dotInt8(features_q, array.data + index * REID_FEATURE_DIM,
+                                       REID_FEATURE_DIM);
+    return dot * scale * array.scales[index];
+#else
+    (void)features_q;
+    (void)scale;
+    return ReIDKernels::dotFloat(features, array.data + index * REID_FEATURE_DIM, REID_FEATURE_DIM);
+#endif
+}
+
+float ReIDGallery::exactSimilarity(int slot, const float* features, const int8_t* features_q,
+                                   float scale) {
+    float similarity = vectorSimilarity(templates_, slot, features, features_q, scale);
+    return refineSimilarity(slot, similarity, features, features_q, scale);
+}
+
+float ReIDGallery::refineSimilarity(int slot, float similarity, const float* features,
+                                    const int8_t* features_q, float scale) {
+    // 只在邊界區間比對樣本: 明確匹配或明確不匹配時不需額外成本
+    if (similarity < borderline_low_ || similarity >= borderline_high_) {
+        return similarity;
+    }
+    int n = exemplar_count_[slot];
+    if (n > 0) total_exemplar_checks_++;
+    for (int e = 0; e < n; e++) {
+        float s = vectorSimilarity(exemplars_, (size_t)slot * REID_GALLERY_EXEMPLARS + e,
+                                   features, features_q, scale);
+        if (s > similarity) similarity = s;
+    }
+    return similarity;
+}
+
+int ReIDGallery::selectCandidates(const ReIDSignature& signature, int k) {
+    // Hamming 距離只有 0..128，用直方圖找出第 K 名的距離 (O(N)，不需排序)
+    uint32_t histogram[REID_GALLERY_SIGNATURE_BITS + 1];
+    memset(histogram, 0, sizeof(histogram));
+    
+    for (int i = 0; i < count_; i++) {
+        uint8_t d = (uint8_t)hammingDistance(signature, signatures_[i]);
+        distances_[i] = d;
+        histogram[d]++;
+    }
+    
+    int cutoff = 0;
+    uint32_t below = 0;   // 距離 < cutoff 的數量
+    while (cutoff < REID_GALLERY_SIGNATURE_BITS &&
+           below + histogram[cutoff] < (uint32_t)k) {
+        below += histogram[cutoff];
+        cutoff++;
+    }
+    
+    // 先收距離 < cutoff 的全部，再以距離 == cutoff 的補滿 K 個
+    int num = 0;
+    int ties_left = k - (int)below;
+    for (int i = 0; i < count_ && num < k; i++) {
+        if (distances_[i] < cutoff) {
+            candidates_[num++] = i;
+        } else if (distances_[i] == cutoff && ties_left > 0) {
+            candidates_[num++] = i;
+            ties_left--;
+        }
+    }
+    return num;
+}
+
+int ReIDGallery::search(const float* features, float* best_similarity) {
+    if (count_ == 0) return -1;
+    
+    query_scale_ = ReIDKernels::quantize(features, query_q_, REID_FEATURE_DIM);
+    total_searches_++;
+    
+    int best_slot = -1;
+    float best = -2.0f;
+    
+    if (count_ <= REID_GALLERY_RERANK_K) {
+        // 小 gallery 直接全部精算
+        for (int i = 0; i < count_; i++) {
+            float similarity = exactSimilarity(i, features, query_q_, query_scale_);
+            if (similarity > best) {
+                best = similarity;
+                best_slot = i;
+            }
+        }
+        total_rescored_ += count_;
+    } else {
+        int num = selectCandidates(computeSignature(query_q_), REID_GALLERY_RERANK_K);
+        for (int c = 0; c < num; c++) {
+            float similarity = exactSimilarity(candidates_[c], features, query_q_, query_scale_);
+            if (similarity > best) {
+                best = similarity;
+                best_slot = candidates_[c];
+            }
+        }
+        total_rescored_ += num;
+    }
+    
+    if (best_similarity) *best_similarity = best;
+    return best_slot;
+}
+
+int ReIDGallery::buildSimilarityMatrix(const float* const* features, int num_queries,
+                                       int* columns, int max_columns, float* similarity) {
+    if (count_ == 0 || num_queries <= 0) return 0;
+    if (num_queries > REID_GALLERY_MAX_QUERIES) num_queries = REID_GALLERY_MAX_QUERIES;
+    if (max_columns > REID_GALLERY_MAX_COLUMNS) max_columns = REID_GALLERY_MAX_COLUMNS;
+    
+    for (int q = 0; q < num_queries; q++) {
+        batch_scales[q] = ReIDKernels::quantize(features[q], batch_queries_q[q], REID_FEATURE_DIM);
+    }
+    
+    // Step 1: 決定欄 (小 gallery 全取，否則取各查詢粗篩候選的聯集)
+    int num_columns = 0;
+    if (count_ <= max_columns) {
+        for (int i = 0; i < count_; i++) columns[num_columns++] = i;
+    } else {
+        // 每個查詢分到的候選數，確保欄數不超過上限
+        int k = max_columns / num_queries;
+        k = k > REID_GALLERY_RERANK_K ? REID_GALLERY_RERANK_K : k;
+        k = k < 1 ? 1 : k;
+        for (int q = 0; q < num_queries && num_columns < max_columns; q++) {
+            int num = selectCandidates(computeSignature(batch_queries_q[q]), k);
+            for (int c = 0; c < num && num_columns < max_columns; c++) {
+                int slot = candidates_[c];
+                if (!column_marks_[slot]) {
+                    column_marks_[slot] = 1;
+                    columns[num_columns++] = slot;
+                }
+            }
+        }
+        for (int c = 0; c < num_columns; c++) column_marks_[columns[c]] = 0;
+    }
+    
+    // Step 2: 逐欄計算相似度，每筆 gallery 特徵只讀取一次
+    for (int c = 0; c < num_columns; c++) {
+        int slot = columns[c];
+#if REID_GALLERY_INT8
+        int32_t dots[REID_GALLERY_MAX_QUERIES];
+        ReIDKernels::dotInt8Multi(&batch_queries_q[0][0], num_queries,
+                                  templates_.data + (size_t)slot * REID_FEATURE_DIM,
+                                  REID_FEATURE_DIM, dots);
+        for (int q = 0; q < num_queries; q++) {
+            similarity[q * num_columns + c] = dots[q] * batch_scales[q] * templates_.scales[slot];
+        }
+#else
+        for (int q = 0; q < num_queries; q++) {
+            similarity[q * num_columns + c] = ReIDKernels::dotFloat(
+                features[q], templates_.data + (size_t)slot * REID_FEATURE_DIM, REID_FEATURE_DIM);
+        }
+#endif
+        for (int q = 0; q < num_queries; q++) {
+            float& sim = similarity[q * num_columns + c];
+            sim = refineSimilarity(slot, sim, features[q], batch_queries_q[q], batch_scales[q]);
+        }
+    }
+    
+    total_searches_ += num_queries;
+    total_rescored_ += num_columns * num_queries;
+    return num_columns;
+}
+
+int ReIDGallery::add(const float* features, int person_id, uint32_t frame, int* evicted_id) {
+    if (evicted_id) *evicted_id = -1;
+    if (capacity_ == 0) return -1;
+    
+    int slot = count_;
+    if (count_ >= capacity_) {
+        // 覆寫最久未出現的資料
+        slot = 0;
+        for (int i = 1; i < count_; i++) {
+            if (last_seen_[i] < last_seen_[slot]) {
+                slot = i;
+            }
+        }
+        if (evicted_id) *evicted_id = person_ids_[slot];
+    } else {
+        count_++;
+    }
+    
+    float scale = ReIDKernels::quantize(features, query_q_, REID_FEATURE_DIM);
+    writeVector(templates_, slot, features, query_q_, scale);
+    signatures_[slot] = computeSignature(query_q_);
+    exemplar_count_[slot] = 0;
+    exemplar_next_[slot] = 0;
+    person_ids_[slot] = person_id;
+    last_seen_[slot] = frame;
+    return slot;
+}
+
+int ReIDGallery::findPerson(int person_id) const {
+    for (int i = 0; i < count_; i++) {
+        if (person_ids_[i] == person_id) return i;
+    }
+    return -1;
+}
+
+void ReIDGallery::update(int slot, const float* features, uint32_t frame) {
+    if (slot < 0 || slot >= count_) return;
+    last_seen_[slot] = frame;
+    
+    float scale = ReIDKernels::quantize(features, query_q_, REID_FEATURE_DIM);
+    
+    // 外觀與模板及現有樣本都差異夠大時，收為新樣本 (ring 覆寫最舊的)
+#if REID_GALLERY_EXEMPLARS > 0
+    {
+        float max_similarity = vectorSimilarity(templates_, slot, features, query_q_, scale);
+        int n = exemplar_count_[slot];
+        for (int e = 0; e < n; e++) {
+            float s = vectorSimilarity(exemplars_, (size_t)slot * REID_GALLERY_EXEMPLARS + e,
+                                       features, query_q_, scale);
+            if (s > max_similarity) max_similarity = s;
+        }
+        if (max_similarity < REID_GALLERY_EXEMPLAR_DIVERSITY) {
+            int e = exemplar_next_[slot];
+            writeVector(exemplars_, (size_t)slot * REID_GALLERY_EXEMPLARS + e, features, query_q_, scale);
+            exemplar_next_[slot] = (uint8_t)((e + 1) % REID_GALLERY_EXEMPLARS);
+            if (n < REID_GALLERY_EXEMPLARS) exemplar_count_[slot] = (uint8_t)(n + 1);
+        }
+    }
+#endif
+    
+    // EMA 模板更新後重新正規化，並更新粗篩簽章
+    readVector(templates_, slot, float_scratch);
+    float norm = 0.0f;
+    for (int i = 0; i < REID_FEATURE_DIM; i++) {
+        float v = (1.0f - REID_GALLERY_EMA_ALPHA) * float_scratch[i] + REID_GALLERY_EMA_ALPHA * features[i];
+        float_scratch[i] = v;
+        norm += v * v;
+    }
+    norm = sqrtf(norm);
+    if (norm <= 0.0f) return;
+    for (int i = 0; i < REID_FEATURE_DIM; i++) float_scratch[i] /= norm;
+    
+    scale = ReIDKernels::quantize(float_scratch, query_q_, REID_FEATURE_DIM);
+    writeVector(templates_, slot, float_scratch, query_q_, scale);
+    signatures_[slot] = computeSignature(query_q_);
+}
+
+// 寫入一個向量 (依檔案格式轉換)
+static bool writeFileVector(FILE* fp, const float* values, bool store_int8) {
+    if (store_int8) {
+        float scale = ReIDKernels::quantize(values, io_scratch_q, REID_FEATURE_DIM);
+        return fwrite(io_scratch_q, 1, REID_FEATURE_DIM, fp) == REID_FEATURE_DIM &&
+               fwrite(&scale, sizeof(scale), 1, fp) == 1;
+    }
+    return fwrite(values, sizeof(float), REID_FEATURE_DIM, fp) == REID_FEATURE_DIM;
+}
+
+// 讀取一個向量並轉為浮點
+static bool readFileVector(FILE* fp, float* values, bool stored_int8) {
+    if (stored_int8) {
+        float scale;
+        if (fread(io_scratch_q, 1, REID_FEATURE_DIM, fp) != REID_FEATURE_DIM ||
+            fread(&scale, sizeof(scale), 1, fp) != 1) {
+            return false;
+        }
+        for (int i = 0; i < REID_FEATURE_DIM; i++) values[i] = io_scratch_q[i] * scale;
+        return true;
+    }
+    return fread(values, sizeof(float), REID_FEATURE_DIM, fp) == REID_FEATURE_DIM;
+}
+
+bool ReIDGallery::save(const char* path, int32_t next_person_id, bool store_int8) const {
+#if REID_GALLERY_INT8
+    store_int8 = true;
+#endif
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        printf("[ReID] Failed to open %s for writing\n", path);
+        return false;
+    }
+    
+    ReIDGalleryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = REID_GALLERY_FILE_MAGIC;
+    header.version = REID_GALLERY_FILE_VERSION;
+    header.flags = store_int8 ? REID_GALLERY_FILE_INT8 : 0;
+    header.feature_dim = REID_FEATURE_DIM;
+    header.num_exemplars = REID_GALLERY_EXEMPLARS;
+    header.signature_words = REID_GALLERY_SIGNATURE_WORDS;
+    header.count = count_;
+    header.next_person_id = next_person_id;
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    
+    for (int slot = 0; slot < count_ && ok; slot++) {
+        ReIDGalleryFileRecord record;
+        memset(&record, 0, sizeof(record));
+        record.person_id = person_ids_[slot];
+        record.last_seen = last_seen_[slot];
+        record.exemplar_count = exemplar_count_[slot];
+        record.exemplar_next = exemplar_next_[slot];
+        ok = fwrite(&record, sizeof(record), 1, fp) == 1 &&
+             fwrite(&signatures_[slot], sizeof(ReIDSignature), 1, fp) == 1;
+        
+        readVector(templates_, slot, float_scratch);
+        ok = ok && writeFileVector(fp, float_scratch, store_int8);
+        for (int e = 0; e < record.exemplar_count && ok; e++) {
+            readVector(exemplars_, (size_t)slot * REID_GALLERY_EXEMPLARS + e, float_scratch);
+            ok = writeFileVector(fp, float_scratch, store_int8);
+        }
+    }
+    
+    fclose(fp);
+    if (!ok) {
+        printf("[ReID] Failed to write gallery to %s\n", path);
+        return false;
+    }
+    printf("[ReID] Gallery saved: %d persons -> %s (%s)\n",
+           count_, path, store_int8 ? "int8" : "float");
+    return true;
+}
+
+bool ReIDGallery::load(const char* path, int32_t* next_person_id) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    
+    ReIDGalleryFileHeader header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != REID_GALLERY_FILE_MAGIC ||
+        header.version != REID_GALLERY_FILE_VERSION ||
+        header.feature_dim != REID_FEATURE_DIM) {
+        printf("[ReID] %s is not a compatible gallery file\n", path);
+        fclose(fp);
+        return false;
+    }
+    
+    // 簽章格式不同時於載入後重新計算
+    const bool stored_int8 = (header.flags & REID_GALLERY_FILE_INT8) != 0;
+    const bool reuse_signatures = header.signature_words == REID_GALLERY_SIGNATURE_WORDS;
+    const size_t signature_bytes = header.signature_words * sizeof(uint64_t);
+    
+    int loaded = 0;
+    bool ok = true;
+    for (uint32_t n = 0; n < header.count && ok; n++) {
+        ReIDGalleryFileRecord record;
+        ReIDSignature signature;
+        if (fread(&record, sizeof(record), 1, fp) != 1) {
+            ok = false;
+            break;
+        }
+        if (reuse_signatures) {
+            ok = fread(&signature, sizeof(signature), 1, fp) == 1;
+        } else {
+            ok = fseek(fp, (long)signature_bytes, SEEK_CUR) == 0;
+        }
+        ok = ok && readFileVector(fp, float_scratch, stored_int8);
+        if (!ok) break;
+        
+        // 超出容量的資料略過 (仍需讀完以維持檔案位置)
+        bool keep = loaded < capacity_;
+        if (keep) {
+            float scale = ReIDKernels::quantize(float_scratch, query_q_, REID_FEATURE_DIM);
+            writeVector(templates_, loaded, float_scratch, query_q_, scale);
+            signatures_[loaded] = reuse_signatures ? signature : computeSignature(query_q_);
+            person_ids_[loaded] = record.person_id;
+            // 存檔中的 last_seen 是上次執行的幀號，與本次的幀號無關:
+            // 一律視為最舊 (0)，已滿時先淘汰載入的資料 (同值時淘汰較前面的 slot)
+            last_seen_[loaded] = 0;
+            exemplar_count_[loaded] = 0;
+            exemplar_next_[loaded] = 0;
+        }
+        
+        for (int e = 0; e < record.exemplar_count && ok; e++) {
+            ok = readFileVector(fp, float_scratch, stored_int8);
+#if REID_GALLERY_EXEMPLARS > 0
+            if (ok && keep && e < REID_GALLERY_EXEMPLARS) {
+                float scale = ReIDKernels::quantize(float_scratch, query_q_, REID_FEATURE_DIM);
+                writeVector(exemplars_, (size_t)loaded * REID_GALLERY_EXEMPLARS + e,
+                            float_scratch, query_q_, scale);
+                exemplar_count_[loaded] = (uint8_t)(e + 1);
+            }
+#endif
+        }
+        if (keep) {
+#if REID_GALLERY_EXEMPLARS > 0
+            exemplar_next_[loaded] = (uint8_t)(record.exemplar_next < exemplar_count_[loaded]
+                                               ? record.exemplar_next
+                                               : exemplar_count_[loaded] % REID_GALLERY_EXEMPLARS);
+#endif
+            loaded++;
+        }
+    }
+    fclose(fp);
+    
+    if (!ok) {
+        printf("[ReID] Gallery file %s truncated, loaded %d entries\n", path, loaded);
+    }
+    if ((uint32_t)loaded < header.count) {
+        printf("[ReID] Gallery capacity %d < %lu stored entries, extra entries dropped\n",
+               capacity_, (unsigned long)header.count);
+    }
+    
+    count_ = loaded;
+    if (next_person_id) *next_person_id = header.next_person_id;
+    printf("[ReID] Gallery loaded: %d persons from %s (%s)\n",
+           count_, path, stored_int8 ? "int8" : "float");
+    return true;
+}
@@ -0,0 +1,185 @@
+/*
+ * reid_gallery.h - 可擴充的 Re-ID 特徵庫
+ *
+ * 容量依執行時的記憶體預算決定 (靜態 pool，預設位於 .ddr_data，見 MEM_PLACE_GALLERY)，
+ * 以 SoA 方式存放特徵、scale、簽章與 metadata。
+ * 搜尋分兩階段:
+ *   1. 粗篩: 128-bit 隨機投影符號簽章，以 Hamming 距離選出前 K 名
+ *   2. 精算: 只對候選者計算完整 512 維內積
+ * 每筆資料保存 EMA 模板，以及最多 K 個外觀差異較大的樣本 (ring)；
+ * 模板相似度落在邊界區間時才比對樣本。
+ */
+
+#ifndef REID_GALLERY_H
+#define REID_GALLERY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define REID_FEATURE_DIM  512
+
+// Gallery 以 int8 (per-vector scale) 儲存特徵，記憶體為 float 的 1/4
+#ifndef REID_GALLERY_INT8
+#define REID_GALLERY_INT8 1
+#endif
+
+// Gallery pool 上限 (bytes)，實際容量由 init() 的預算決定
+#ifndef REID_GALLERY_POOL_SIZE
+#define REID_GALLERY_POOL_SIZE (4 * 1024 * 1024)
+#endif
+
+// 粗篩簽章位元數與精算候選數
+#define REID_GALLERY_SIGNATURE_WORDS 2
+#define REID_GALLERY_SIGNATURE_BITS  (REID_GALLERY_SIGNATURE_WORDS * 64)
+#define REID_GALLERY_RERANK_K        64
+
+// 整幀批次匹配: 查詢數與相似度矩陣欄數 (候選 gallery 資料) 上限
+#define REID_GALLERY_MAX_QUERIES     32
+#define REID_GALLERY_MAX_COLUMNS     256
+
+// 每筆資料保存的樣本數 (0 表示只使用 EMA 模板)
+#ifndef REID_GALLERY_EXEMPLARS
+#define REID_GALLERY_EXEMPLARS 2
+#endif
+
+// EMA 模板更新率: template = normalize((1 - a) * template + a * query)
+#define REID_GALLERY_EMA_ALPHA          0.1f
+
+// 新觀測與模板及所有樣本的相似度皆低於此值才收為樣本 (保持多樣性)
+#define REID_GALLERY_EXEMPLAR_DIVERSITY 0.85f
+
+struct ReIDSignature {
+    uint64_t words[REID_GALLERY_SIGNATURE_WORDS];
+};
+
+// 特徵陣列 (模板或樣本)，int8 模式附帶 per-vector scale
+struct ReIDFeatureArray {
+#if REID_GALLERY_INT8
+    int8_t* data;
+    float* scales;
+#else
+    float* data;
+#endif
+};
+
+// Gallery 存檔格式 (little-endian)
+// [檔頭][每筆: 記錄頭 + 簽章 + 模板 + exemplar_count 個樣本]
+// 向量以 int8 (+ float scale) 或 float 儲存，由 flags 決定
+#define REID_GALLERY_FILE_MAGIC    0x4C414752u   // "RGAL"
+#define REID_GALLERY_FILE_VERSION  1
+#define REID_GALLERY_FILE_INT8     0x0001
+
+struct ReIDGalleryFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint16_t feature_dim;
+    uint16_t num_exemplars;     // 每筆最多樣本數
+    uint16_t signature_words;
+    uint16_t reserved;
+    uint32_t count;
+    int32_t next_person_id;
+};
+
+struct ReIDGalleryFileRecord {
+    int32_t person_id;
+    uint32_t last_seen;         // 存檔時的幀號 (僅供參考，載入時不沿用)
+    uint8_t exemplar_count;
+    uint8_t exemplar_next;
+    uint16_t reserved;
+};
+
+class ReIDGallery {
+public:
+    ReIDGallery();
+    
+    // 依預算 (bytes) 切割 pool，回傳是否至少能容納一筆
+    bool init(size_t budget_bytes);
+    
+    int size() const { return count_; }
+    int capacity() const { return capacity_; }
+    
+    // 每筆資料佔用的 bytes (含粗篩簽章與 metadata)
+    static size_t bytesPerEntry();
+    
+    // 模板相似度落在 [low, high) 時另外比對樣本，取最大值
+    void setBorderlineBand(float low, float high) {
+        borderline_low_ = low;
+        borderline_high_ = high;
+    }
+    
+    // 兩階段搜尋，回傳最相似的 slot (空 gallery 回傳 -1)
+    int search(const float* features, float* best_similarity);
+    
+    // 整幀批次: 收集所有查詢的候選 slot 作為欄 (columns)，
+    // 並一次計算 num_queries x num_columns 的相似度矩陣 (row-major)
+    // 回傳欄數 (gallery 小於 max_columns 時即為全部資料)
+    int buildSimilarityMatrix(const float* const* features, int num_queries,
+                              int* columns, int max_columns, float* similarity);
+    
+    // 加入新資料，已滿時覆寫最久未出現的 slot
+    // evicted_id 回傳被覆寫的 person_id (未覆寫為 -1)
+    int add(const float* features, int person_id, uint32_t frame, int* evicted_id);
+    
+    // 匹配後更新: EMA 模板、必要時收為新樣本，並更新 last_seen
+    void update(int slot, const float* features, uint32_t frame);
+    
+    // 以 semihosting 檔案 I/O 存檔 / 載入
+    // store_int8: 向量以 int8 儲存 (int8 gallery 一律如此)
+    // 載入時會轉換向量格式與樣本數，不需重新推論；載入資料的 last_seen 歸零
+    bool save(const char* path, int32_t next_person_id, bool store_int8) const;
+    bool load(const char* path, int32_t* next_person_id);
+    
+    int personId(int slot) const { return person_ids_[slot]; }
+    int findPerson(int person_id) const;   // 找不到回傳 -1
+    uint32_t lastSeen(int slot) const { return last_seen_[slot]; }
+    int exemplarCount(int slot) const { return exemplar_count_[slot]; }
+    void touch(int slot, uint32_t frame) { last_seen_[slot] = frame; }
+    
+    // 統計: 搜尋次數、精算的候選總數
+    uint32_t searchCount() const { return total_searches_; }
+    uint32_t rescoredCount() const { return total_rescored_; }
+    uint32_t exemplarCheckCount() const { return total_exemplar_checks_; }
+    
+private:
+    int capacity_;
+    int count_;
+    
+    // SoA 儲存 (指向 pool 內)
+    ReIDFeatureArray templates_;   // capacity x REID_FEATURE_DIM
+    ReIDFeatureArray exemplars_;   // capacity x REID_GALLERY_EXEMPLARS x REID_FEATURE_DIM
+    uint8_t* exemplar_count_;
+    uint8_t* exemplar_next_;       // ring 下一個覆寫位置
+    ReIDSignature* signatures_;
+    int32_t* person_ids_;
+    uint32_t* last_seen_;
+    uint8_t* distances_;        // 搜尋時的 Hamming 距離暫存
+    uint8_t* column_marks_;     // 批次收集候選時的去重標記
+    int candidates_[REID_GALLERY_RERANK_K];
+    
+    // 查詢特徵 (量化後) 與其 scale
+    int8_t query_q_[REID_FEATURE_DIM];
+    float query_scale_;
+    
+    float borderline_low_;
+    float borderline_high_;
+    
+    uint32_t total_searches_;
+    uint32_t total_rescored_;
+    uint32_t total_exemplar_checks_;
+    
+    void initProjection();
+    ReIDSignature computeSignature(const int8_t* features_q) const;
+    static void writeVector(ReIDFeatureArray& array, size_t index, const float* features,
+                            const int8_t* features_q, float scale);
+    static void readVector(const ReIDFeatureArray& array, size_t index, float* out);
+    static float vectorSimilarity(const ReIDFeatureArray& array, size_t index, const float* features,
+                                  const int8_t* features_q, float scale);
+    float exactSimilarity(int slot, const float* features, const int8_t* features_q,
+                          float scale);
+    float refineSimilarity(int slot, float similarity, const float* features,
+                           const int8_t* features_q, float scale);
+    int selectCandidates(const ReIDSignature& signature, int k);
+};
+
+#endif // REID_GALLERY_H
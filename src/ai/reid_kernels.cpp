@@ -0,0 +1,125 @@
+#include "reid_kernels.h"
+#include <cmath>
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define REID_KERNELS_USE_MVE 1
+#if (__ARM_FEATURE_MVE & 2)
+#define REID_KERNELS_USE_MVE_FP 1
+#endif
+#endif
+
+float ReIDKernels::dotFloatScalar(const float* a, const float* b, int dim) {
+    // 四組累加器，降低相依鏈長度 (host 編譯器也較容易向量化)
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    int i = 0;
+    for (; i + 4 <= dim; i += 4) {
+        acc0 += a[i + 0] * b[i + 0];
+        acc1 += a[i + 1] * b[i + 1];
+        acc2 += a[i + 2] * b[i + 2];
+        acc3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < dim; i++) {
+        acc0 += a[i] * b[i];
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+float ReIDKernels::dotFloat(const float* a, const float* b, int dim) {
+#if defined(REID_KERNELS_USE_MVE_FP)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    int remaining = dim;
+    while (remaining > 0) {
+        mve_pred16_t p = vctp32q((uint32_t)remaining);
+        float32x4_t va = vldrwq_z_f32(a, p);
+        float32x4_t vb = vldrwq_z_f32(b, p);
+        acc = vfmaq_m_f32(acc, va, vb, p);
+        a += 4;
+        b += 4;
+        remaining -= 4;
+    }
+    return vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+           vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+#else
+    return dotFloatScalar(a, b, dim);
+#endif
+}
+
+float ReIDKernels::quantize(const float* src, int8_t* dst, int dim) {
+    float max_abs = 0.0f;
+    for (int i = 0; i < dim; i++) {
+        float v = fabsf(src[i]);
+        if (v > max_abs) max_abs = v;
+    }
+    
+    if (max_abs == 0.0f) {
+        for (int i = 0; i < dim; i++) dst[i] = 0;
+        return 0.0f;
+    }
+    
+    float scale = max_abs / 127.0f;
+    float inv_scale = 127.0f / max_abs;
+    for (int i = 0; i < dim; i++) {
+        // |src| <= max_abs，結果必在 [-127, 127]
+        dst[i] = (int8_t)lroundf(src[i] * inv_scale);
+    }
+    return scale;
+}
+
+int32_t ReIDKernels::dotInt8Scalar(const int8_t* a, const int8_t* b, int dim) {
+    int32_t acc = 0;
+    for (int i = 0; i < dim; i++) {
+        acc += (int32_t)a[i] * (int32_t)b[i];
+    }
+    return acc;
+}
+
+int32_t ReIDKernels::dotInt8(const int8_t* a, const int8_t* b, int dim) {
+#if defined(REID_KERNELS_USE_MVE)
+    // 每次 16 個 int8 相乘並累加到 int32 (VMLADAVA)，尾端以 predicate 處理
+    int32_t acc = 0;
+    int remaining = dim;
+    while (remaining > 0) {
+        mve_pred16_t p = vctp8q((uint32_t)remaining);
+        int8x16_t va = vldrbq_z_s8(a, p);
+        int8x16_t vb = vldrbq_z_s8(b, p);
+        acc = vmladavaq_p_s8(acc, va, vb, p);
+        a += 16;
+        b += 16;
+        remaining -= 16;
+    }
+    return acc;
+#else
+    return dotInt8Scalar(a, b, dim);
+#endif
+}
+
+void ReIDKernels::dotInt8Multi(const int8_t* queries, int num_queries, const int8_t* b,
+                               int dim, int32_t* out) {
+    int q = 0;
+#if defined(REID_KERNELS_USE_MVE)
+    // 4 筆查詢一組: b 的每個 16-byte 區塊只載入一次
+    for (; q + 4 <= num_queries; q += 4) {
+        const int8_t* a0 = queries + (q + 0) * dim;
+        const int8_t* a1 = queries + (q + 1) * dim;
+        const int8_t* a2 = queries + (q + 2) * dim;
+        const int8_t* a3 = queries + (q + 3) * dim;
+        int32_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+        for (int i = 0; i < dim; i += 16) {
+            mve_pred16_t p = vctp8q((uint32_t)(dim - i));
+            int8x16_t vb = vldrbq_z_s8(b + i, p);
+            acc0 = vmladavaq_p_s8(acc0, vldrbq_z_s8(a0 + i, p), vb, p);
+            acc1 = vmladavaq_p_s8(acc1, vldrbq_z_s8(a1 + i, p), vb, p);
+            acc2 = vmladavaq_p_s8(acc2, vldrbq_z_s8(a2 + i, p), vb, p);
+            acc3 = vmladavaq_p_s8(acc3, vldrbq_z_s8(a3 + i, p), vb, p);
+        }
+        out[q + 0] = acc0;
+        out[q + 1] = acc1;
+        out[q + 2] = acc2;
+        out[q + 3] = acc3;
+    }
+#endif
+    for (; q < num_queries; q++) {
+        out[q] = dotInt8(queries + q * dim, b, dim);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef REID_KERNELS_H
+#define REID_KERNELS_H
+
+#include <stdint.h>
+
+// Re-ID 特徵相似度 kernel
+// 特徵皆已 L2 正規化，cosine similarity 即為內積。
+// 於 Cortex-M55 使用 Helium (MVE) 路徑，其他平台使用純量版本。
+class ReIDKernels {
+public:
+    // float 內積
+    static float dotFloat(const float* a, const float* b, int dim);
+    
+    // dotFloat 的純量參考實作
+    static float dotFloatScalar(const float* a, const float* b, int dim);
+    
+    // 對稱量化為 int8 (zero_point = 0)，回傳 per-vector scale: x ≈ q * scale
+    static float quantize(const float* src, int8_t* dst, int dim);
+    
+    // int8 內積 (int32 累加)，相似度 = dotInt8 * scale_a * scale_b
+    static int32_t dotInt8(const int8_t* a, const int8_t* b, int dim);
+    
+    // dotInt8 的純量參考實作
+    static int32_t dotInt8Scalar(const int8_t* a, const int8_t* b, int dim);
+    
+    // 多筆查詢對同一向量的內積 (矩陣乘法的一欄)
+    // queries 為 num_queries x dim (row-major)，b 每次載入後與 4 筆查詢共用
+    static void dotInt8Multi(const int8_t* queries, int num_queries, const int8_t* b,
+                             int dim, int32_t* out);
+};
+
+#endif // REID_KERNELS_H
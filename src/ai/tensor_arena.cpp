@@ -0,0 +1,70 @@
+#include "tensor_arena.h"
+#include "mem_placement.h"
+#include <stdio.h>
+
+#include "tensorflow/lite/micro/micro_allocator.h"
+
+static const char* const kModelNames[TENSOR_ARENA_NUM_MODELS] = { "YOLO", "ReID" };
+
+static size_t used_bytes[TENSOR_ARENA_NUM_MODELS];
+
+#if TENSOR_ARENA_SHARED
+static uint8_t shared_arena[TENSOR_ARENA_SHARED_SIZE] MEM_PLACE(MEM_PLACE_TENSOR_ARENA);
+static uint8_t yolo_persistent_arena[YOLO_PERSISTENT_ARENA_SIZE] MEM_PLACE(MEM_PLACE_TENSOR_ARENA);
+static uint8_t reid_persistent_arena[REID_PERSISTENT_ARENA_SIZE] MEM_PLACE(MEM_PLACE_TENSOR_ARENA);
+
+void* TensorArena::createAllocator(TensorArenaModel model) {
+    uint8_t* persistent = (model == TENSOR_ARENA_YOLO) ? yolo_persistent_arena : reid_persistent_arena;
+    size_t persistent_size = (model == TENSOR_ARENA_YOLO) ? YOLO_PERSISTENT_ARENA_SIZE : REID_PERSISTENT_ARENA_SIZE;
+    
+    if (model == TENSOR_ARENA_YOLO) {
+        MemPlacement::record("tensor arena (shared)", shared_arena, sizeof(shared_arena));
+    }
+    MemPlacement::record(model == TENSOR_ARENA_YOLO ? "YOLO persistent arena" : "ReID persistent arena",
+                         persistent, persistent_size);
+    
+    return tflite::MicroAllocator::Create(persistent, persistent_size,
+                                          shared_arena, TENSOR_ARENA_SHARED_SIZE);
+}
+#else
+void* TensorArena::createAllocator(TensorArenaModel model) {
+    return nullptr;
+}
+#endif
+
+void TensorArena::recordUsage(TensorArenaModel model, size_t used, size_t reserved) {
+    used_bytes[model] = used;
+    printf("[%s] Arena used: %u / %u bytes\n", kModelNames[model],
+           (unsigned)used, (unsigned)reserved);
+}
+
+void TensorArena::printReport() {
+    // used 含 persistent 與 non-persistent，加總即各自配置所需的最小大小
+    size_t used_total = 0;
+    for (int m = 0; m < TENSOR_ARENA_NUM_MODELS; m++) {
+        used_total += used_bytes[m];
+    }
+    const size_t separate = YOLO_TENSOR_ARENA_SIZE + REID_TENSOR_ARENA_SIZE;
+    
+#if TENSOR_ARENA_SHARED
+    const size_t total = TENSOR_ARENA_SHARED_SIZE + YOLO_PERSISTENT_ARENA_SIZE + REID_PERSISTENT_ARENA_SIZE;
+    printf("[Arena] Shared non-persistent: %u KB, persistent: YOLO %u KB + ReID %u KB\n",
+           (unsigned)(TENSOR_ARENA_SHARED_SIZE / 1024),
+           (unsigned)(YOLO_PERSISTENT_ARENA_SIZE / 1024),
+           (unsigned)(REID_PERSISTENT_ARENA_SIZE / 1024));
+#else
+    const size_t total = separate;
+    printf("[Arena] Separate arenas\n");
+#endif
+    for (int m = 0; m < TENSOR_ARENA_NUM_MODELS; m++) {
+        printf("  %-5s used %u bytes\n", kModelNames[m], (unsigned)used_bytes[m]);
+    }
+    printf("  Total reserved: %u KB\n", (unsigned)(total / 1024));
+    printf("  Separate arenas: YOLO %u KB + ReID %u KB = %u KB (sum of used: %u KB)\n",
+           (unsigned)(YOLO_TENSOR_ARENA_SIZE / 1024), (unsigned)(REID_TENSOR_ARENA_SIZE / 1024),
+           (unsigned)(separate / 1024), (unsigned)(used_total / 1024));
+#if TENSOR_ARENA_SHARED
+    printf("  Saving vs separate arenas: %d KB\n",
+           (int)(((long)separate - (long)total) / 1024));
+#endif
+}
@@ -0,0 +1,57 @@
+#ifndef TENSOR_ARENA_H
+#define TENSOR_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// YOLO 與 Re-ID 共用 tensor arena
+// 兩個模型在 processFrame() 中不會同時 Invoke，因此 activation
+// (non-persistent) 區域可以共用；persistent 配置 (tensor metadata、
+// op user data) 各自獨立。代價是另一個模型 Invoke 之後，本模型的
+// 輸入/輸出張量內容即失效，呼叫端必須在下一次 Invoke 前讀完輸出。
+#ifndef TENSOR_ARENA_SHARED
+#define TENSOR_ARENA_SHARED 1
+#endif
+
+// 共用 activation 區域 (需容納兩個模型中較大者)
+#ifndef TENSOR_ARENA_SHARED_SIZE
+#define TENSOR_ARENA_SHARED_SIZE (1536 * 1024)
+#endif
+
+// 各模型的 persistent 區域
+#ifndef YOLO_PERSISTENT_ARENA_SIZE
+#define YOLO_PERSISTENT_ARENA_SIZE (128 * 1024)
+#endif
+#ifndef REID_PERSISTENT_ARENA_SIZE
+#define REID_PERSISTENT_ARENA_SIZE (128 * 1024)
+#endif
+
+// 非共用模式 (SHARED_TENSOR_ARENA=OFF) 各模型的獨立 arena，
+// 共用模式下作為節省量的比較基準
+#ifndef YOLO_TENSOR_ARENA_SIZE
+#define YOLO_TENSOR_ARENA_SIZE (1024 * 1024)
+#endif
+#ifndef REID_TENSOR_ARENA_SIZE
+#define REID_TENSOR_ARENA_SIZE (2 * 1024 * 1024)
+#endif
+
+enum TensorArenaModel {
+    TENSOR_ARENA_YOLO = 0,
+    TENSOR_ARENA_REID,
+    TENSOR_ARENA_NUM_MODELS
+};
+
+class TensorArena {
+public:
+    // 建立模型的 MicroAllocator (tflite::MicroAllocator*)，
+    // 非共用模式或空間不足時回傳 nullptr
+    static void* createAllocator(TensorArenaModel model);
+    
+    // 記錄 AllocateTensors() 後的 arena_used_bytes() 與保留大小
+    static void recordUsage(TensorArenaModel model, size_t used_bytes, size_t reserved_bytes);
+    
+    // 輸出各模型用量、總保留大小，以及相對獨立 arena 的節省量
+    static void printReport();
+};
+
+#endif // TENSOR_ARENA_H
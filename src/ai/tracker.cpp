@@ -0,0 +1,223 @@
+#include "tracker.h"
+#include "assignment.h"
+#include <stdio.h>
+#include <string.h>
+
+// Kalman 雜訊參數 (YOLO 輸入座標，像素)
+#define TRACKER_PROCESS_NOISE_POS 1.0f
+#define TRACKER_PROCESS_NOISE_VEL 0.25f
+#define TRACKER_MEASURE_NOISE     4.0f
+#define TRACKER_INIT_VEL_VAR      100.0f
+
+static_assert(TRACKER_MAX_TRACKS <= ASSIGNMENT_MAX_SHORT &&
+              YOLO_MAX_DETECTIONS <= ASSIGNMENT_MAX_DIM,
+              "Tracker association exceeds assignment solver limits");
+
+// 關聯用的成本矩陣 (軌跡 x 偵測)
+static float tracker_cost[TRACKER_MAX_TRACKS * YOLO_MAX_DETECTIONS];
+
+Tracker::Tracker()
+    : next_track_id_(0)
+    , total_detections_(0)
+    , total_reid_requests_(0)
+    , total_tracks_created_(0)
+{
+    memset(tracks_, 0, sizeof(tracks_));
+}
+
+void Tracker::initAxis(KalmanAxis& axis, float value) {
+    axis.pos = value;
+    axis.vel = 0.0f;
+    axis.p00 = TRACKER_MEASURE_NOISE;
+    axis.p01 = 0.0f;
+    axis.p11 = TRACKER_INIT_VEL_VAR;
+}
+
+void Tracker::predictAxis(KalmanAxis& axis) {
+    // x' = F x, P' = F P F^T + Q，F = [1 1; 0 1]
+    axis.pos += axis.vel;
+    axis.p00 += 2.0f * axis.p01 + axis.p11 + TRACKER_PROCESS_NOISE_POS;
+    axis.p01 += axis.p11;
+    axis.p11 += TRACKER_PROCESS_NOISE_VEL;
+}
+
+void Tracker::correctAxis(KalmanAxis& axis, float measurement) {
+    // 只量測位置: H = [1 0]
+    float s = axis.p00 + TRACKER_MEASURE_NOISE;
+    float k0 = axis.p00 / s;
+    float k1 = axis.p01 / s;
+    float residual = measurement - axis.pos;
+    
+    axis.pos += k0 * residual;
+    axis.vel += k1 * residual;
+    
+    float p00 = axis.p00, p01 = axis.p01;
+    axis.p00 = (1.0f - k0) * p00;
+    axis.p01 = (1.0f - k0) * p01;
+    axis.p11 -= k1 * p01;
+}
+
+Box Tracker::trackBox(const Track& track) {
+    Box box;
+    box.w = track.axes[2].pos;
+    box.h = track.axes[3].pos;
+    box.x = track.axes[0].pos - box.w * 0.5f;
+    box.y = track.axes[1].pos - box.h * 0.5f;
+    return box;
+}
+
+void Tracker::correctTrack(Track& track, const Box& box) {
+    correctAxis(track.axes[0], box.x + box.w * 0.5f);
+    correctAxis(track.axes[1], box.y + box.h * 0.5f);
+    correctAxis(track.axes[2], box.w);
+    correctAxis(track.axes[3], box.h);
+    track.misses = 0;
+}
+
+int Tracker::createTrack(const Box& box) {
+    for (int t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        if (tracks_[t].active) continue;
+        
+        Track& track = tracks_[t];
+        track.active = true;
+        track.track_id = next_track_id_++;
+        track.person_id = -1;
+        track.misses = 0;
+        track.last_reid_frame = 0;
+        initAxis(track.axes[0], box.x + box.w * 0.5f);
+        initAxis(track.axes[1], box.y + box.h * 0.5f);
+        initAxis(track.axes[2], box.w);
+        initAxis(track.axes[3], box.h);
+        total_tracks_created_++;
+        return t;
+    }
+    return -1;
+}
+
+bool Tracker::isAmbiguous(const PersonDetection* detections, int count, int index) const {
+    for (int j = 0; j < count; j++) {
+        if (j == index) continue;
+        if (YoloPoseDetector::boxIou(detections[index].bbox, detections[j].bbox) > TRACKER_AMBIGUOUS_IOU) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Tracker::update(const PersonDetection* detections, int count, uint32_t frame,
+                    TrackResult* results) {
+    if (count > YOLO_MAX_DETECTIONS) count = YOLO_MAX_DETECTIONS;
+    
+    // Step 1: 預測
+    int track_slots[TRACKER_MAX_TRACKS];
+    int num_tracks = 0;
+    for (int t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        if (!tracks_[t].active) continue;
+        for (int a = 0; a < 4; a++) predictAxis(tracks_[t].axes[a]);
+        track_slots[num_tracks++] = t;
+    }
+    
+    // Step 2: 以 1 - IoU 為成本做一對一關聯
+    int det_to_track[YOLO_MAX_DETECTIONS];
+    for (int i = 0; i < count; i++) det_to_track[i] = -1;
+    
+    if (num_tracks > 0 && count > 0) {
+        for (int r = 0; r < num_tracks; r++) {
+            Box predicted = trackBox(tracks_[track_slots[r]]);
+            for (int i = 0; i < count; i++) {
+                tracker_cost[r * count + i] = 1.0f - YoloPoseDetector::boxIou(predicted, detections[i].bbox);
+            }
+        }
+        
+        int track_to_det[TRACKER_MAX_TRACKS];
+        Assignment::solveMin(tracker_cost, num_tracks, count, track_to_det);
+        for (int r = 0; r < num_tracks; r++) {
+            int i = track_to_det[r];
+            if (i >= 0 && 1.0f - tracker_cost[r * count + i] >= TRACKER_IOU_THRESHOLD) {
+                det_to_track[i] = track_slots[r];
+            }
+        }
+    }
+    
+    // Step 3: 更新已關聯軌跡，未關聯的偵測建立新軌跡
+    int num_reid = 0;
+    for (int i = 0; i < count; i++) {
+        int t = det_to_track[i];
+        bool is_new = false;
+        
+        if (t >= 0) {
+            correctTrack(tracks_[t], detections[i].bbox);
+            tracks_[t].misses = -1;   // 標記本幀已關聯 (Step 4 歸零)
+        } else {
+            t = createTrack(detections[i].bbox);
+            is_new = true;
+            if (t >= 0) tracks_[t].misses = -1;
+        }
+        
+        TrackResult& result = results[i];
+        if (t < 0) {
+            // 軌跡已滿: 無法追蹤，每幀都做 Re-ID
+            result.track_id = -1;
+            result.person_id = -1;
+            result.needs_reid = true;
+        } else {
+            const Track& track = tracks_[t];
+            result.track_id = track.track_id;
+            result.person_id = track.person_id;
+            result.needs_reid = is_new || track.person_id < 0 ||
+                                isAmbiguous(detections, count, i) ||
+                                frame - track.last_reid_frame >= TRACKER_REID_INTERVAL;
+        }
+        if (result.needs_reid) num_reid++;
+    }
+    
+    // Step 4: 未關聯的軌跡累計 miss，過久則刪除
+    for (int t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        Track& track = tracks_[t];
+        if (!track.active) continue;
+        if (track.misses < 0) {
+            track.misses = 0;
+        } else if (++track.misses > TRACKER_MAX_MISSES) {
+            track.active = false;
+        }
+    }
+    
+    total_detections_ += count;
+    total_reid_requests_ += num_reid;
+    return num_reid;
+}
+
+void Tracker::setPersonId(int track_id, int person_id, uint32_t frame) {
+    if (track_id < 0) return;
+    for (int t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        Track& track = tracks_[t];
+        if (track.active && track.track_id == track_id) {
+            if (track.person_id >= 0 && track.person_id != person_id) {
+                printf("[Tracker] Track %d re-identified: Person ID %d -> %d\n",
+                       track_id, track.person_id, person_id);
+            }
+            track.person_id = person_id;
+            track.last_reid_frame = frame;
+            return;
+        }
+    }
+}
+
+int Tracker::activeTracks() const {
+    int n = 0;
+    for (int t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        if (tracks_[t].active) n++;
+    }
+    return n;
+}
+
+void Tracker::printStats() const {
+    printf("[Tracker] Statistics:\n");
+    printf("  Active tracks: %d\n", activeTracks());
+    printf("  Tracks created: %lu\n", (unsigned long)total_tracks_created_);
+    if (total_detections_ > 0) {
+        printf("  Re-ID requested: %lu/%lu detections (%.1f%% skipped)\n",
+               (unsigned long)total_reid_requests_, (unsigned long)total_detections_,
+               100.0f * (total_detections_ - total_reid_requests_) / total_detections_);
+    }
+}
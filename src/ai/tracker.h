@@ -0,0 +1,82 @@
+/*
+ * tracker.h - IoU + Kalman 多人追蹤器
+ *
+ * 位於 YOLO 偵測與 Re-ID 之間，跨幀延續 person ID。
+ * 只有以下情況才需要 Re-ID:
+ *   - 新建立的軌跡 (或尚未取得 person ID)
+ *   - 與其他偵測重疊 (可能互換身分)
+ *   - 距離上次 Re-ID 超過 TRACKER_REID_INTERVAL 幀 (重新驗證)
+ */
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <stdint.h>
+#include "yolo_pose.h"
+
+#define TRACKER_MAX_TRACKS       32
+#define TRACKER_IOU_THRESHOLD    0.3f   // 關聯所需的最小 IoU
+#define TRACKER_AMBIGUOUS_IOU    0.3f   // 偵測間重疊超過此值視為不確定
+#define TRACKER_MAX_MISSES       15     // 連續未關聯幀數超過即刪除軌跡
+
+// 重新驗證間隔 (幀)，可由 CMake 覆寫
+#ifndef TRACKER_REID_INTERVAL
+#define TRACKER_REID_INTERVAL    30
+#endif
+
+// 單一維度的等速 Kalman filter (位置 + 速度)
+struct KalmanAxis {
+    float pos, vel;
+    float p00, p01, p11;    // 共變異數 (對稱)
+};
+
+struct Track {
+    int track_id;
+    int person_id;          // -1 表示尚未經 Re-ID 確認
+    KalmanAxis axes[4];     // 中心 x, 中心 y, 寬, 高
+    int misses;
+    uint32_t last_reid_frame;
+    bool active;
+};
+
+// 每個偵測的追蹤結果
+struct TrackResult {
+    int track_id;
+    int person_id;          // 沿用軌跡的 ID (needs_reid 時可能為 -1)
+    bool needs_reid;
+};
+
+class Tracker {
+public:
+    Tracker();
+    
+    // 預測所有軌跡、與本幀偵測做一對一關聯，並更新 / 建立 / 刪除軌跡
+    // results[i] 對應 detections[i]，回傳需要 Re-ID 的偵測數
+    int update(const PersonDetection* detections, int count, uint32_t frame,
+               TrackResult* results);
+    
+    // Re-ID 完成後寫回軌跡的 person ID
+    void setPersonId(int track_id, int person_id, uint32_t frame);
+    
+    int activeTracks() const;
+    void printStats() const;
+    
+private:
+    Track tracks_[TRACKER_MAX_TRACKS];
+    int next_track_id_;
+    
+    uint32_t total_detections_;
+    uint32_t total_reid_requests_;
+    uint32_t total_tracks_created_;
+    
+    static void initAxis(KalmanAxis& axis, float value);
+    static void predictAxis(KalmanAxis& axis);
+    static void correctAxis(KalmanAxis& axis, float measurement);
+    
+    static Box trackBox(const Track& track);
+    void correctTrack(Track& track, const Box& box);
+    int createTrack(const Box& box);
+    bool isAmbiguous(const PersonDetection* detections, int count, int index) const;
+};
+
+#endif // TRACKER_H
@@ -0,0 +1,40 @@
+#ifndef YOLO_ANCHORS_H
+#define YOLO_ANCHORS_H
+
+// YOLOv8 anchor / stride 表 (編譯期產生)
+// 以 structure-of-arrays 排列，順序與合併後的輸出一致: stride 8 -> 16 -> 32，
+// 每個尺度內為 row-major。宣告為 constexpr 物件時會放在 .rodata (flash)，不使用 heap。
+template <int W, int H>
+struct YoloAnchorGrid {
+    static constexpr int kNumStride8  = (W / 8) * (H / 8);
+    static constexpr int kNumStride16 = (W / 16) * (H / 16);
+    static constexpr int kNumStride32 = (W / 32) * (H / 32);
+    static constexpr int kTotal = kNumStride8 + kNumStride16 + kNumStride32;
+    
+    float x[kTotal];       // anchor 中心 (grid 座標)
+    float y[kTotal];
+    float stride[kTotal];
+    
+    constexpr YoloAnchorGrid() : x(), y(), stride() {
+        int idx = 0;
+        for (int s = 8; s <= 32; s *= 2) {
+            const int grid_w = W / s;
+            const int grid_h = H / s;
+            for (int gy = 0; gy < grid_h; gy++) {
+                for (int gx = 0; gx < grid_w; gx++) {
+                    x[idx] = (float)gx + 0.5f;
+                    y[idx] = (float)gy + 0.5f;
+                    stride[idx] = (float)s;
+                    idx++;
+                }
+            }
+        }
+    }
+};
+
+template <int W, int H> constexpr int YoloAnchorGrid<W, H>::kNumStride8;
+template <int W, int H> constexpr int YoloAnchorGrid<W, H>::kNumStride16;
+template <int W, int H> constexpr int YoloAnchorGrid<W, H>::kNumStride32;
+template <int W, int H> constexpr int YoloAnchorGrid<W, H>::kTotal;
+
+#endif // YOLO_ANCHORS_H
@@ -1,5 +1,11 @@
 #include "yolo_pose.h"
+#include "yolo_anchors.h"
 #include "image_utils.h"
+#include "npu_hooks.h"
+#include "profiler.h"
+#include "op_profiler.h"
+#include "tensor_arena.h"
+#include "mem_placement.h"
 #include <stdio.h>
 #include <string.h>
 #include <cmath>
@@ -9,6 +15,7 @@ extern "C" uint32_t SystemCoreClock;
 
 // TensorFlow Lite Micro
 #include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -17,13 +24,24 @@ extern TFLMRegistration* Register_ETHOSU();
 extern const char* GetString_ETHOSU();
 }
 
-#define YOLO_TENSOR_ARENA_SIZE (1024 * 1024)  // 1MB
-static uint8_t yolo_tensor_arena[YOLO_TENSOR_ARENA_SIZE] __attribute__((section(".ddr_data"), aligned(16)));
+#if !TENSOR_ARENA_SHARED
+static uint8_t yolo_tensor_arena[YOLO_TENSOR_ARENA_SIZE] MEM_PLACE(MEM_PLACE_TENSOR_ARENA);
+#endif
+
+// 運算子層級 profiler (APP_PROFILING 關閉時不掛到 interpreter)
+static OpProfiler yolo_op_profiler("YOLO");
 
 // YOLOv8 後處理參數
 #define MODEL_SCORE_THRESHOLD 0.25f
 #define MODEL_NMS_THRESHOLD 0.6f
-#define NUM_OUTPUTS 7
+
+// Anchor 和 Stride 表 (編譯期產生，預設位於 flash，MEM_PLACE_LUTS 可移至 SRAM/DTCM)
+static constexpr YoloAnchorGrid<YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT> kAnchorGrid MEM_PLACE_RO(MEM_PLACE_LUTS) {};
+static_assert(YoloAnchorGrid<YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT>::kTotal == YOLO_TOTAL_ANCHORS,
+              "Anchor grid size mismatch");
+
+// 各尺度 DFL exp 查表 (解碼迴圈每個 bbox 查 64 次)
+static float yolo_dfl_exp_lut[YOLO_NUM_SCALES][256] MEM_PLACE(MEM_PLACE_LUTS);
 
 YoloPoseDetector::YoloPoseDetector()
     : interpreter_(nullptr)
@@ -31,92 +49,112 @@ YoloPoseDetector::YoloPoseDetector()
     , tensor_arena_(nullptr)
     , total_inferences_(0)
     , total_inference_time_(0.0f)
-    , stride_array_(nullptr)
-    , anchor_array_(nullptr)
-    , total_anchors_(0)
+    , total_postprocess_time_(0.0f)
+    , total_candidates_(0)
+    , npu_pmu_()
+    , dfl_exp_lut_(nullptr)
+    , use_dfl_lut_(YOLO_DFL_USE_LUT != 0)
+    , use_letterbox_(YOLO_USE_LETTERBOX != 0)
+    , last_nms_iou_evals_(0)
+    , total_nms_iou_evals_(0)
 {
+#if !TENSOR_ARENA_SHARED
     tensor_arena_ = yolo_tensor_arena;
-    out_dim_size_[0] = 0;
-    out_dim_size_[1] = 0;
-    out_dim_size_[2] = 0;
-}
-
-YoloPoseDetector::~YoloPoseDetector() {
-    freeAnchorsAndStrides();
+#endif
+    dfl_exp_lut_ = yolo_dfl_exp_lut;
+    memset(output_quant_, 0, sizeof(output_quant_));
+    memset(scale_levels_, 0, sizeof(scale_levels_));
+    memset(yolo_dfl_exp_lut, 0, sizeof(yolo_dfl_exp_lut));
+    memset(&scratch_, 0, sizeof(scratch_));
+    input_transform_ = ImageUtils::stretchTransform(YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT,
+                                                    YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT);
 }
 
-void YoloPoseDetector::initAnchorsAndStrides() {
-    // 計算總 anchor 數量（256x256 輸入）
-    // stride 8: 32x32 = 1024
-    // stride 16: 16x16 = 256
-    // stride 32: 8x8 = 64
-    // 總計: 1344
-    int dim_stride_8_size = (YOLO_INPUT_WIDTH / 8) * (YOLO_INPUT_HEIGHT / 8);   // 1024
-    int dim_stride_16_size = (YOLO_INPUT_WIDTH / 16) * (YOLO_INPUT_HEIGHT / 16); // 256
-    int dim_stride_32_size = (YOLO_INPUT_WIDTH / 32) * (YOLO_INPUT_HEIGHT / 32); // 64
-    int dim_total_size = dim_stride_8_size + dim_stride_16_size + dim_stride_32_size; // 1344
-    
-    total_anchors_ = dim_total_size;
-    
-    // 分配 stride 陣列
-    stride_array_ = (float*)calloc(dim_total_size, sizeof(float));
-    
-    // 分配 anchor 陣列
-    anchor_array_ = (float**)calloc(dim_total_size, sizeof(float*));
-    for (int i = 0; i < dim_total_size; i++) {
-        anchor_array_[i] = (float*)calloc(2, sizeof(float));
-    }
-    
-    // 記錄尺度邊界
-    out_dim_size_[0] = dim_stride_8_size;                          // 1024
-    out_dim_size_[1] = dim_stride_8_size + dim_stride_16_size;     // 1280
-    out_dim_size_[2] = dim_total_size;                             // 1344
+bool YoloPoseDetector::initOutputQuant() {
+    auto* interpreter = (tflite::MicroInterpreter*)interpreter_;
     
-    // 填充 stride 陣列和 anchor 陣列
-    int strides[] = {8, 16, 32};
-    int sizes[] = {dim_stride_8_size, dim_stride_16_size, dim_stride_32_size};
-    int start_step = 0;
+    size_t num_outputs = interpreter->outputs_size();
+    if (num_outputs != YOLO_NUM_OUTPUTS) {
+        printf("[YOLO] Expected %d outputs, got %zu\n", YOLO_NUM_OUTPUTS, num_outputs);
+        return false;
+    }
     
-    for (int scale = 0; scale < 3; scale++) {
-        int stride = strides[scale];
-        int grid_size = YOLO_INPUT_WIDTH / stride;
-        int size = sizes[scale];
+    // 快取每個輸出的資料指標與量化參數 (AllocateTensors 之後位址固定)
+    for (int i = 0; i < YOLO_NUM_OUTPUTS; i++) {
+        TfLiteTensor* t = interpreter->output(i);
+        auto* quant = (TfLiteAffineQuantization*)(t->quantization.params);
+        if (quant == nullptr || quant->scale->size < 1 || quant->zero_point->size < 1) {
+            printf("[YOLO] Output[%d] is not per-tensor quantized\n", i);
+            return false;
+        }
         
-        for (int i = 0; i < size; i++) {
-            int idx = start_step + i;
-            stride_array_[idx] = (float)stride;
-            
-            // anchor 座標
-            int y = i / grid_size;
-            int x = i % grid_size;
-            anchor_array_[idx][0] = x + 0.5f;
-            anchor_array_[idx][1] = y + 0.5f;
+        output_quant_[i].data = t->data.int8;
+        output_quant_[i].row_size = t->dims->data[2];
+        output_quant_[i].scale = quant->scale->data[0];
+        output_quant_[i].zero_point = quant->zero_point->data[0];
+        
+        printf("[YOLO] Output[%d] dims: ", i);
+        for (int d = 0; d < t->dims->size; d++) {
+            printf("%d ", t->dims->data[d]);
         }
-        start_step += size;
+        printf("scale=%f zp=%ld\n", output_quant_[i].scale, (long)output_quant_[i].zero_point);
     }
     
-    printf("[YOLO] Anchors and strides initialized (%d total)\n", dim_total_size);
-    printf("[YOLO] Scale boundaries: %d, %d, %d\n", out_dim_size_[0], out_dim_size_[1], out_dim_size_[2]);
-}
-
-void YoloPoseDetector::freeAnchorsAndStrides() {
-    if (stride_array_) {
-        free(stride_array_);
-        stride_array_ = nullptr;
+    // 根據實際輸出張量維度 (256x256 輸入):
+    // Output[0] dims: 1 256 64   <- stride 16 的 bbox
+    // Output[1] dims: 1 1024 64  <- stride 8 的 bbox
+    // Output[2] dims: 1 64 1     <- stride 32 的 confidence
+    // Output[3] dims: 1 1344 51  <- keypoints (所有尺度合併)
+    // Output[4] dims: 1 1024 1   <- stride 8 的 confidence
+    // Output[5] dims: 1 64 64    <- stride 32 的 bbox
+    // Output[6] dims: 1 256 1    <- stride 16 的 confidence
+    const int strides[YOLO_NUM_SCALES] = {8, 16, 32};
+    const int conf_outputs[YOLO_NUM_SCALES] = {4, 6, 2};
+    const int bbox_outputs[YOLO_NUM_SCALES] = {1, 0, 5};
+    
+    int anchor_offset = 0;
+    for (int s = 0; s < YOLO_NUM_SCALES; s++) {
+        YoloScaleLevel& level = scale_levels_[s];
+        level.stride = strides[s];
+        level.conf_output = conf_outputs[s];
+        level.bbox_output = bbox_outputs[s];
+        level.anchor_offset = anchor_offset;
+        level.num_anchors = (YOLO_INPUT_WIDTH / strides[s]) * (YOLO_INPUT_HEIGHT / strides[s]);
+        level.conf_threshold_q = computeConfThreshold(output_quant_[level.conf_output]);
+        level.dfl_exp_lut = dfl_exp_lut_[s];
+        initDflLut(output_quant_[level.bbox_output], dfl_exp_lut_[s]);
+        anchor_offset += level.num_anchors;
+        
+        printf("[YOLO] Stride %d: %d anchors, int8 score threshold %ld\n",
+               level.stride, level.num_anchors, (long)level.conf_threshold_q);
     }
     
-    if (anchor_array_) {
-        for (int i = 0; i < total_anchors_; i++) {
-            if (anchor_array_[i]) {
-                free(anchor_array_[i]);
-            }
+    printf("[YOLO] DFL decode: %s\n", use_dfl_lut_ ? "LUT" : "float");
+    printf("[YOLO] Preprocess: %s\n", use_letterbox_ ? "letterbox" : "stretch");
+    
+    return true;
+}
+
+int32_t YoloPoseDetector::computeConfThreshold(const YoloOutputQuant& conf) const {
+    // sigmoid 與反量化皆為單調遞增，因此 sigmoid(dequant(q)) >= MODEL_SCORE_THRESHOLD
+    // 等價於 q >= 某個 int8 門檻。直接以浮點路徑逐值判定，保證與原本的結果完全一致。
+    for (int32_t q = -128; q <= 127; q++) {
+        if (sigmoid(dequantize((int8_t)q, conf.scale, conf.zero_point)) >= MODEL_SCORE_THRESHOLD) {
+            return q;
         }
-        free(anchor_array_);
-        anchor_array_ = nullptr;
     }
+    return 128;
 }
 
-float YoloPoseDetector::sigmoid(float x) {
+void YoloPoseDetector::initDflLut(const YoloOutputQuant& bbox, float* lut) const {
+    // softmax 對平移不變: exp(x_i - x_max) = exp((q_i - q_max) * scale)，
+    // zero point 互相抵消，因此只需以 q_max - q_i 索引 (0..255)
+    for (int d = 0; d < 256; d++) {
+        lut[d] = expf(-(float)d * bbox.scale);
+    }
+}
+
+float YoloPoseDetector::sigmoid(float x) const {
     return 1.0f / (1.0f + expf(-x));
 }
 
@@ -137,27 +175,19 @@ void YoloPoseDetector::softmax(float* input, size_t len) {
     }
 }
 
-float YoloPoseDetector::dequantize(int8_t value, float scale, int32_t zero_point) {
+float YoloPoseDetector::dequantize(int8_t value, float scale, int32_t zero_point) const {
     return ((float)value - (float)zero_point) * scale;
 }
 
-float YoloPoseDetector::getBboxDequantValue(int dim1, int dim2, void* tensor) {
-    auto* t = (TfLiteTensor*)tensor;
-    int8_t value = t->data.int8[dim2 + dim1 * t->dims->data[2]];
-    auto* quant = (TfLiteAffineQuantization*)(t->quantization.params);
-    float scale = quant->scale->data[0];
-    int32_t zero_point = quant->zero_point->data[0];
-    return dequantize(value, scale, zero_point);
+float YoloPoseDetector::getBboxDequantValue(int dim1, int dim2, const YoloOutputQuant& out) const {
+    int8_t value = out.data[dim2 + dim1 * out.row_size];
+    return dequantize(value, out.scale, out.zero_point);
 }
 
-float YoloPoseDetector::getKeypointDequantValue(int dim1, int dim2, void* tensor,
-                                                  float anchor0, float anchor1, float stride) {
-    auto* t = (TfLiteTensor*)tensor;
-    int8_t value = t->data.int8[dim2 + dim1 * t->dims->data[2]];
-    auto* quant = (TfLiteAffineQuantization*)(t->quantization.params);
-    float scale = quant->scale->data[0];
-    int32_t zero_point = quant->zero_point->data[0];
-    float deq_value = dequantize(value, scale, zero_point);
+float YoloPoseDetector::getKeypointDequantValue(int dim1, int dim2, const YoloOutputQuant& out,
+                                                  float anchor0, float anchor1, float stride) const {
+    int8_t value = out.data[dim2 + dim1 * out.row_size];
+    float deq_value = dequantize(value, out.scale, out.zero_point);
     
     // 根據 keypoint 類型處理
     if (dim2 % 3 == 0) {
@@ -174,8 +204,44 @@ float YoloPoseDetector::getKeypointDequantValue(int dim1, int dim2, void* tensor
     return deq_value;
 }
 
-void YoloPoseDetector::calculateXYWH(int j, void** outputs, Box* bbox, int* out_dim_size) {
+float YoloPoseDetector::decodeDflFloat(int local_idx, int k, const YoloOutputQuant& out) {
+    float tmp_arr[YOLO_DFL_BINS];
+    float result = 0.0f;
+    
+    for (int i = 0; i < YOLO_DFL_BINS; i++) {
+        tmp_arr[i] = getBboxDequantValue(local_idx, k * YOLO_DFL_BINS + i, out);
+    }
+    
+    // Softmax
+    softmax(tmp_arr, YOLO_DFL_BINS);
+    
+    // 加權平均
+    for (int i = 0; i < YOLO_DFL_BINS; i++) {
+        result += tmp_arr[i] * (float)i;
+    }
+    return result;
+}
+
+float YoloPoseDetector::decodeDflLut(const int8_t* bins, const float* lut) const {
+    int8_t max_q = bins[0];
+    for (int i = 1; i < YOLO_DFL_BINS; i++) {
+        if (bins[i] > max_q) max_q = bins[i];
+    }
+    
+    // 最大的 bin 查表值恆為 1，sum >= 1 不會除以零
+    float sum = 0.0f;
+    float weighted = 0.0f;
+    for (int i = 0; i < YOLO_DFL_BINS; i++) {
+        float e = lut[(int)max_q - (int)bins[i]];
+        sum += e;
+        weighted += e * (float)i;
+    }
+    return weighted / sum;
+}
+
+void YoloPoseDetector::calculateXYWH(const YoloScaleLevel& level, int local_idx, int j, Box* bbox) {
     float xywh_result[4];
+    const YoloOutputQuant& out = output_quant_[level.bbox_output];
     
     // DFL (Distribution Focal Loss) 解碼
     // 根據實際輸出張量維度:
@@ -183,47 +249,22 @@ void YoloPoseDetector::calculateXYWH(int j, void** outputs, Box* bbox, int* out_
     // Output[0] (256 x 64) = stride 16 的 bbox
     // Output[5] (64 x 64) = stride 32 的 bbox
     
-    for (int k = 0; k < 4; k++) {
-        float tmp_arr[16];
-        float result = 0.0f;
-        
-        for (int i = 0; i < 16; i++) {
-            int output_idx;
-            int local_j;
-            float tmp_result;
-            
-            if (j < out_dim_size[0]) {
-                // stride 8
-                output_idx = 1;
-                local_j = j;
-            } else if (j < out_dim_size[1]) {
-                // stride 16
-                output_idx = 0;
-                local_j = j - out_dim_size[0];
-            } else {
-                // stride 32
-                output_idx = 5;
-                local_j = j - out_dim_size[1];
-            }
-            tmp_result = getBboxDequantValue(local_j, k * 16 + i, outputs[output_idx]);
-            tmp_arr[i] = tmp_result;
+    if (use_dfl_lut_) {
+        const int8_t* row = out.data + local_idx * out.row_size;
+        for (int k = 0; k < 4; k++) {
+            xywh_result[k] = decodeDflLut(row + k * YOLO_DFL_BINS, level.dfl_exp_lut);
         }
-        
-        // Softmax
-        softmax(tmp_arr, 16);
-        
-        // 加權平均
-        for (int i = 0; i < 16; i++) {
-            result += tmp_arr[i] * (float)i;
+    } else {
+        for (int k = 0; k < 4; k++) {
+            xywh_result[k] = decodeDflFloat(local_idx, k, out);
         }
-        xywh_result[k] = result;
     }
     
     // dist2bbox * stride
-    float x1 = anchor_array_[j][0] - xywh_result[0];
-    float y1 = anchor_array_[j][1] - xywh_result[1];
-    float x2 = anchor_array_[j][0] + xywh_result[2];
-    float y2 = anchor_array_[j][1] + xywh_result[3];
+    float x1 = kAnchorGrid.x[j] - xywh_result[0];
+    float y1 = kAnchorGrid.y[j] - xywh_result[1];
+    float x2 = kAnchorGrid.x[j] + xywh_result[2];
+    float y2 = kAnchorGrid.y[j] + xywh_result[3];
     
     float cx = (x1 + x2) / 2.0f;
     float cy = (y1 + y2) / 2.0f;
@@ -231,10 +272,11 @@ void YoloPoseDetector::calculateXYWH(int j, void** outputs, Box* bbox, int* out_
     float h = y2 - y1;
     
     // 乘以 stride
-    cx *= stride_array_[j];
-    cy *= stride_array_[j];
-    w *= stride_array_[j];
-    h *= stride_array_[j];
+    const float stride = kAnchorGrid.stride[j];
+    cx *= stride;
+    cy *= stride;
+    w *= stride;
+    h *= stride;
     
     // 轉換為左上角座標
     bbox->x = cx - 0.5f * w;
@@ -243,6 +285,30 @@ void YoloPoseDetector::calculateXYWH(int j, void** outputs, Box* bbox, int* out_
     bbox->h = h;
 }
 
+void YoloPoseDetector::decodeKeypoints(int anchor_idx, HumanPose* kpts) const {
+    // 從 Output[3] (1344 x 51) 解碼 17 個 keypoints
+    const YoloOutputQuant& kpt_out = output_quant_[3];
+    const float anchor0 = kAnchorGrid.x[anchor_idx];
+    const float anchor1 = kAnchorGrid.y[anchor_idx];
+    const float stride = kAnchorGrid.stride[anchor_idx];
+    
+    for (int k = 0; k < NUM_KEYPOINTS; k++) {
+        float kpt_x = getKeypointDequantValue(anchor_idx, k * 3, kpt_out, anchor0, anchor1, stride);
+        float kpt_y = getKeypointDequantValue(anchor_idx, k * 3 + 1, kpt_out, anchor0, anchor1, stride);
+        float kpt_score = getKeypointDequantValue(anchor_idx, k * 3 + 2, kpt_out, anchor0, anchor1, stride);
+        
+        // 限制在圖像範圍內
+        if (kpt_x < 0) kpt_x = 0;
+        if (kpt_y < 0) kpt_y = 0;
+        if (kpt_x >= YOLO_INPUT_WIDTH) kpt_x = YOLO_INPUT_WIDTH - 1;
+        if (kpt_y >= YOLO_INPUT_HEIGHT) kpt_y = YOLO_INPUT_HEIGHT - 1;
+        
+        kpts[k].x = (uint32_t)kpt_x;
+        kpts[k].y = (uint32_t)kpt_y;
+        kpts[k].score = kpt_score;
+    }
+}
+
 float YoloPoseDetector::boxIou(const Box& a, const Box& b) {
     // 計算交集
     float x1 = std::max(a.x, b.x);
@@ -260,41 +326,54 @@ float YoloPoseDetector::boxIou(const Box& a, const Box& b) {
     return intersection / union_area;
 }
 
-void YoloPoseDetector::nmsBoxes(std::vector<Box>& boxes, std::vector<float>& confidences,
-                                  float scoreThreshold, float nmsThreshold, std::vector<int>& result) {
-    // 建立索引和置信度的配對
-    struct DetPair {
-        int index;
-        float conf;
-        Box box;
-    };
-    
-    std::vector<DetPair> pairs;
-    for (size_t i = 0; i < boxes.size(); i++) {
-        pairs.push_back({(int)i, confidences[i], boxes[i]});
+int YoloPoseDetector::nmsBoxes(const Box* boxes, const float* confidences, int count,
+                               float scoreThreshold, float nmsThreshold,
+                               int maxDetections, int* result) {
+    last_nms_iou_evals_ = 0;
+    if (count <= 0 || maxDetections <= 0) return 0;
+    if (count > YOLO_TOTAL_ANCHORS) count = YOLO_TOTAL_ANCHORS;
+    
+    int* order = scratch_.nms_order;
+    uint32_t* suppressed = scratch_.nms_suppressed;
+    
+    // 建立索引陣列，只對分數最高的 TOP_K 個做部分排序 (降序)
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
     }
-    
-    // 按置信度排序（降序）
-    std::sort(pairs.begin(), pairs.end(), [](const DetPair& a, const DetPair& b) {
-        return a.conf > b.conf;
-    });
-    
-    // NMS
-    for (size_t k = 0; k < pairs.size(); k++) {
-        if (pairs[k].conf < scoreThreshold) continue;
+    int num_sorted = std::min(count, YOLO_NMS_TOP_K);
+    std::partial_sort(order, order + num_sorted, order + count,
+                      [confidences](int a, int b) {
+                          if (confidences[a] != confidences[b]) return confidences[a] > confidences[b];
+                          return a < b;
+                      });
+    
+    // 以 bitmask 標記被抑制的候選，取代 vector::erase
+    memset(suppressed, 0, sizeof(scratch_.nms_suppressed));
+    
+    int num_kept = 0;
+    for (int k = 0; k < num_sorted; k++) {
+        if (suppressed[k >> 5] & (1u << (k & 31))) continue;
+        
+        int idx = order[k];
+        // 已排序，之後的分數只會更低
+        if (confidences[idx] < scoreThreshold) break;
         
-        result.push_back(pairs[k].index);
+        result[num_kept++] = idx;
+        if (num_kept >= maxDetections) break;
         
-        // 移除重疊的框
-        for (size_t j = k + 1; j < pairs.size(); ) {
-            float iou = boxIou(pairs[k].box, pairs[j].box);
-            if (iou > nmsThreshold) {
-                pairs.erase(pairs.begin() + j);
-            } else {
-                j++;
+        // 抑制重疊的框
+        for (int j = k + 1; j < num_sorted; j++) {
+            if (suppressed[j >> 5] & (1u << (j & 31))) continue;
+            
+            last_nms_iou_evals_++;
+            if (boxIou(boxes[idx], boxes[order[j]]) > nmsThreshold) {
+                suppressed[j >> 5] |= (1u << (j & 31));
             }
         }
     }
+    
+    total_nms_iou_evals_ += last_nms_iou_evals_;
+    return num_kept;
 }
 
 bool YoloPoseDetector::init(const void* model_data, size_t model_size) {
@@ -327,10 +406,29 @@ bool YoloPoseDetector::init(const void* model_data, size_t model_size) {
     micro_op_resolver.AddTranspose();
     
     // 建立 Interpreter
+#if TENSOR_ARENA_SHARED
+    // activation 區域與 Re-ID 共用: parseOutput() 必須在 Re-ID Invoke 前完成
+    auto* allocator = (tflite::MicroAllocator*)TensorArena::createAllocator(TENSOR_ARENA_YOLO);
+    if (allocator == nullptr) {
+        printf("[YOLO] Failed to create tensor allocator\n");
+        return false;
+    }
+    static tflite::MicroInterpreter static_interpreter(
+        model, micro_op_resolver, allocator, nullptr,
+        APP_PROFILING ? &yolo_op_profiler : nullptr
+    );
+    const size_t arena_reserved = TENSOR_ARENA_SHARED_SIZE + YOLO_PERSISTENT_ARENA_SIZE;
+#else
     static tflite::MicroInterpreter static_interpreter(
         model, micro_op_resolver, tensor_arena_,
-        YOLO_TENSOR_ARENA_SIZE
+        YOLO_TENSOR_ARENA_SIZE, nullptr,
+        APP_PROFILING ? &yolo_op_profiler : nullptr
     );
+    const size_t arena_reserved = YOLO_TENSOR_ARENA_SIZE;
+    MemPlacement::record("YOLO tensor arena", yolo_tensor_arena, sizeof(yolo_tensor_arena));
+#endif
+    MemPlacement::record("YOLO anchor grid", &kAnchorGrid, sizeof(kAnchorGrid));
+    MemPlacement::record("YOLO DFL LUT", yolo_dfl_exp_lut, sizeof(yolo_dfl_exp_lut));
     
     auto* interpreter = &static_interpreter;
     
@@ -340,6 +438,7 @@ bool YoloPoseDetector::init(const void* model_data, size_t model_size) {
         printf("[YOLO] AllocateTensors failed\n");
         return false;
     }
+    TensorArena::recordUsage(TENSOR_ARENA_YOLO, interpreter->arena_used_bytes(), arena_reserved);
     
     interpreter_ = (void*)interpreter;
     input_tensor_ = (void*)interpreter->input(0);
@@ -349,206 +448,174 @@ bool YoloPoseDetector::init(const void* model_data, size_t model_size) {
     printf("[YOLO] Input: %d x %d x %d\n",
            input->dims->data[1], input->dims->data[2], input->dims->data[3]);
     printf("[YOLO] Num outputs: %zu\n", interpreter->outputs_size());
+    printf("[YOLO] Input quant: scale=%f zp=%ld\n",
+           input->params.scale, (long)input->params.zero_point);
+    if (fabsf(input->params.scale * 255.0f - 1.0f) > 0.01f) {
+        printf("[YOLO] Warning: input scale is not 1/255, preprocessing assumes q = pixel + zp\n");
+    }
     
-    // 初始化 anchors 和 strides
-    initAnchorsAndStrides();
+    printf("[YOLO] Anchor grid: %d anchors (%d/%d/%d), constant table\n",
+           YOLO_TOTAL_ANCHORS, kAnchorGrid.kNumStride8, kAnchorGrid.kNumStride16,
+           kAnchorGrid.kNumStride32);
+    
+    // 快取輸出量化參數並預先計算 int8 分數門檻
+    if (!initOutputQuant()) {
+        return false;
+    }
     
     return true;
 }
 
 void YoloPoseDetector::preprocessImage(const uint8_t* image, int width, int height) {
     auto* input = (TfLiteTensor*)input_tensor_;
-    int8_t* input_data = input->data.int8;
-    
-    // Resize
-    uint8_t* resized = new uint8_t[YOLO_INPUT_WIDTH * YOLO_INPUT_HEIGHT * 3];
     
-    ImageUtils::resize(image, width, height, 
-                      resized, YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT);
+    int32_t zero_point = input->params.zero_point;
     
-    // 轉換為 int8 (減去 128)
-    for (int i = 0; i < YOLO_INPUT_WIDTH * YOLO_INPUT_HEIGHT * 3; i++) {
-        input_data[i] = (int8_t)((int32_t)resized[i] - 128);
+    // Resize + 轉換為 int8 (輸入 scale 為 1/255，q = pixel + zero_point) 一次完成
+    if (use_letterbox_) {
+        // padding 以 zero point 填充 (對應像素值 0)
+        int8_t pad_value = (int8_t)std::max<int32_t>(-128, std::min<int32_t>(127, zero_point));
+        input_transform_ = ImageUtils::letterboxToInt8(image, width, height,
+                                                       input->data.int8, YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT,
+                                                       zero_point, pad_value);
+    } else {
+        ImageUtils::resizeToInt8(image, width, height,
+                                 input->data.int8, YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT,
+                                 zero_point);
+        input_transform_ = ImageUtils::stretchTransform(width, height,
+                                                        YOLO_INPUT_WIDTH, YOLO_INPUT_HEIGHT);
     }
-    
-    delete[] resized;
 }
 
-std::vector<PersonDetection> YoloPoseDetector::parseOutput() {
-    std::vector<PersonDetection> detections;
-    
-    auto* interpreter = (tflite::MicroInterpreter*)interpreter_;
-    
-    // 取得所有輸出張量
-    size_t num_outputs = interpreter->outputs_size();
-    if (num_outputs != NUM_OUTPUTS) {
-        printf("[YOLO] Warning: Expected %d outputs, got %zu\n", NUM_OUTPUTS, num_outputs);
-    }
-    
-    void* outputs[NUM_OUTPUTS];
-    for (int i = 0; i < NUM_OUTPUTS && i < (int)num_outputs; i++) {
-        outputs[i] = (void*)interpreter->output(i);
-        auto* t = (TfLiteTensor*)outputs[i];
-        printf("[YOLO] Output[%d] dims: ", i);
-        for (int d = 0; d < t->dims->size; d++) {
-            printf("%d ", t->dims->data[d]);
-        }
-        printf("\n");
-    }
-    
-    // 根據實際輸出張量維度 (256x256 輸入):
-    // Output[0] dims: 1 256 64   <- stride 16 的 bbox
-    // Output[1] dims: 1 1024 64  <- stride 8 的 bbox
-    // Output[2] dims: 1 64 1     <- stride 32 的 confidence
-    // Output[3] dims: 1 1344 51  <- keypoints (所有尺度合併)
-    // Output[4] dims: 1 1024 1   <- stride 8 的 confidence
-    // Output[5] dims: 1 64 64    <- stride 32 的 bbox
-    // Output[6] dims: 1 256 1    <- stride 16 的 confidence
-    
-    // 使用預先計算的尺度邊界
-    int out_dim_total = total_anchors_;
-    
-    printf("[YOLO] Total anchors: %d\n", out_dim_total);
-    printf("[YOLO] Scale boundaries: stride8=%d, stride8+16=%d, all=%d\n", 
-           out_dim_size_[0], out_dim_size_[1], out_dim_size_[2]);
-    
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
-    std::vector<Box> boxes;
-    std::vector<HumanPose*> kpts_vector;
-    
-    // 遍歷所有候選框
-    for (int dim1 = 0; dim1 < out_dim_total; dim1++) {
-        // 取得置信度
-        // Output[4] (1024 x 1) = stride 8 的 confidence
-        // Output[6] (256 x 1) = stride 16 的 confidence
-        // Output[2] (64 x 1) = stride 32 的 confidence
-        float maxScore = 0.0f;
-        int output_data_idx;
-        int local_idx;
+int YoloPoseDetector::parseOutput(PersonDetection* results, int max_results) {
+    Box* boxes = scratch_.boxes;
+    float* confidences = scratch_.scores;
+    int* anchor_ids = scratch_.anchor_ids;
+    int num_boxes = 0;
+    
+    // 遍歷所有尺度的候選框
+    // 先以 int8 門檻過濾 confidence，只有通過的 anchor 才進行浮點運算
+    {
+        PROFILE_SCOPE(PROF_YOLO_DECODE);
+        for (int s = 0; s < YOLO_NUM_SCALES; s++) {
+            const YoloScaleLevel& level = scale_levels_[s];
+            const YoloOutputQuant& conf = output_quant_[level.conf_output];
         
-        if (dim1 < out_dim_size_[0]) {
-            // stride 8
-            output_data_idx = 4;
-            local_idx = dim1;
-        } else if (dim1 < out_dim_size_[1]) {
-            // stride 16
-            output_data_idx = 6;
-            local_idx = dim1 - out_dim_size_[0];
-        } else {
-            // stride 32
-            output_data_idx = 2;
-            local_idx = dim1 - out_dim_size_[1];
-        }
+            if (level.conf_threshold_q > 127) continue;
+            const int8_t threshold_q = (int8_t)level.conf_threshold_q;
         
-        maxScore = sigmoid(getBboxDequantValue(local_idx, 0, outputs[output_data_idx]));
-        
-        // 過濾低置信度
-        if (maxScore >= MODEL_SCORE_THRESHOLD) {
-            // 計算 bbox
-            Box bbox;
-            calculateXYWH(dim1, outputs, &bbox, out_dim_size_);
+            for (int local_idx = 0; local_idx < level.num_anchors; local_idx++) {
+                int8_t score_q = conf.data[local_idx * conf.row_size];
+                if (score_q < threshold_q) continue;
             
-            // 檢查 bbox 有效性
-            if (bbox.w > 0 && bbox.h > 0 && 
-                bbox.x >= 0 && bbox.y >= 0 &&
-                bbox.x + bbox.w <= YOLO_INPUT_WIDTH && 
-                bbox.y + bbox.h <= YOLO_INPUT_HEIGHT) {
-                
-                boxes.push_back(bbox);
-                class_ids.push_back(0);  // person class
-                confidences.push_back(maxScore);
+                int dim1 = level.anchor_offset + local_idx;
+                float maxScore = sigmoid(dequantize(score_q, conf.scale, conf.zero_point));
+                total_candidates_++;
+            
+                // 計算 bbox
+                Box bbox;
+                calculateXYWH(level, local_idx, dim1, &bbox);
+            
+                // 檢查 bbox 有效性
+                if (bbox.w > 0 && bbox.h > 0 && 
+                    bbox.x >= 0 && bbox.y >= 0 &&
+                    bbox.x + bbox.w <= YOLO_INPUT_WIDTH && 
+                    bbox.y + bbox.h <= YOLO_INPUT_HEIGHT) {
                 
-                // 計算 keypoints (從 Output[3])
-                HumanPose* kpts = new HumanPose[NUM_KEYPOINTS];
-                for (int k = 0; k < NUM_KEYPOINTS; k++) {
-                    float kpt_x = getKeypointDequantValue(
-                        dim1, k * 3, outputs[3],
-                        anchor_array_[dim1][0], anchor_array_[dim1][1], stride_array_[dim1]);
-                    float kpt_y = getKeypointDequantValue(
-                        dim1, k * 3 + 1, outputs[3],
-                        anchor_array_[dim1][0], anchor_array_[dim1][1], stride_array_[dim1]);
-                    float kpt_score = getKeypointDequantValue(
-                        dim1, k * 3 + 2, outputs[3],
-                        anchor_array_[dim1][0], anchor_array_[dim1][1], stride_array_[dim1]);
-                    
-                    // 限制在圖像範圍內
-                    if (kpt_x < 0) kpt_x = 0;
-                    if (kpt_y < 0) kpt_y = 0;
-                    if (kpt_x >= YOLO_INPUT_WIDTH) kpt_x = YOLO_INPUT_WIDTH - 1;
-                    if (kpt_y >= YOLO_INPUT_HEIGHT) kpt_y = YOLO_INPUT_HEIGHT - 1;
-                    
-                    kpts[k].x = (uint32_t)kpt_x;
-                    kpts[k].y = (uint32_t)kpt_y;
-                    kpts[k].score = kpt_score;
+                    boxes[num_boxes] = bbox;
+                    confidences[num_boxes] = maxScore;
+                    anchor_ids[num_boxes] = dim1;
+                    num_boxes++;
                 }
-                kpts_vector.push_back(kpts);
             }
         }
     }
     
-    printf("[YOLO] Before NMS: %zu boxes\n", boxes.size());
+    printf("[YOLO] Before NMS: %d boxes\n", num_boxes);
     
     // NMS
-    std::vector<int> nms_result;
-    nmsBoxes(boxes, confidences, MODEL_SCORE_THRESHOLD, MODEL_NMS_THRESHOLD, nms_result);
+    int* nms_result = scratch_.nms_result;
+    int max_kept = std::min(max_results, YOLO_MAX_DETECTIONS);
+    int num_kept;
+    {
+        PROFILE_SCOPE(PROF_YOLO_NMS);
+        num_kept = nmsBoxes(boxes, confidences, num_boxes,
+                            MODEL_SCORE_THRESHOLD, MODEL_NMS_THRESHOLD,
+                            max_kept, nms_result);
+    }
     
-    printf("[YOLO] After NMS: %zu detections\n", nms_result.size());
+    printf("[YOLO] After NMS: %d detections (%lu IoU evals)\n",
+           num_kept, (unsigned long)last_nms_iou_evals_);
     
     // 建立最終結果
-    for (size_t i = 0; i < nms_result.size(); i++) {
+    for (int i = 0; i < num_kept; i++) {
         int idx = nms_result[i];
-        PersonDetection det;
+        PersonDetection& det = results[i];
         det.bbox = boxes[idx];
         det.confidence = confidences[idx];
         
-        // 複製 keypoints
-        for (int k = 0; k < NUM_KEYPOINTS; k++) {
-            det.keypoints[k] = kpts_vector[idx][k];
-        }
-        
-        detections.push_back(det);
+        // 只為 NMS 保留下來的框解碼 keypoints
+        decodeKeypoints(anchor_ids[idx], det.keypoints);
         
-        printf("[YOLO] Detection %zu: conf=%.3f bbox=(%.1f, %.1f, %.1f, %.1f)\n",
+        printf("[YOLO] Detection %d: conf=%.3f bbox=(%.1f, %.1f, %.1f, %.1f)\n",
                i, det.confidence, det.bbox.x, det.bbox.y, det.bbox.w, det.bbox.h);
     }
     
-    // 釋放臨時 keypoints 記憶體
-    for (auto* kpts : kpts_vector) {
-        delete[] kpts;
-    }
-    
-    return detections;
+    return num_kept;
 }
 
 std::vector<PersonDetection> YoloPoseDetector::detect(const uint8_t* image, int width, int height) {
+    std::vector<PersonDetection> detections(YOLO_MAX_DETECTIONS);
+    int count = detect(image, width, height, detections.data(), YOLO_MAX_DETECTIONS);
+    detections.resize(count);
+    return detections;
+}
+
+int YoloPoseDetector::detect(const uint8_t* image, int width, int height,
+                             PersonDetection* results, int max_results) {
     auto* interpreter = (tflite::MicroInterpreter*)interpreter_;
     
     // Preprocess
-    preprocessImage(image, width, height);
+    {
+        PROFILE_SCOPE(PROF_YOLO_PREPROCESS);
+        preprocessImage(image, width, height);
+    }
     
     // Inference
     uint32_t start = get_cycle_count();
+    uint32_t idle_start = npu_idle_task_cycles();
     
     TfLiteStatus invoke_status = interpreter->Invoke();
     
+    // 扣除 NPU 等待期間執行的 CPU 工作 (管線模式)
     uint32_t end = get_cycle_count();
-    float inference_ms = (end - start) / (float)(SystemCoreClock / 1000);
+    uint32_t busy = (end - start) - (npu_idle_task_cycles() - idle_start);
+    float inference_ms = busy / (float)(SystemCoreClock / 1000);
+    PROFILE_RECORD(PROF_YOLO_INVOKE, busy);
+    yolo_op_profiler.countInvoke();
+    npu_pmu_collect(&npu_pmu_);
     
     total_inferences_++;
     total_inference_time_ += inference_ms;
     
     if (invoke_status != kTfLiteOk) {
         printf("[YOLO] Invoke failed\n");
-        return std::vector<PersonDetection>();
+        return 0;
     }
     
     // Parse output
-    auto detections = parseOutput();
+    uint32_t post_start = get_cycle_count();
     
-    printf("[YOLO] Detected %zu persons (%.1f ms)\n", detections.size(), inference_ms);
+    int count = parseOutput(results, max_results);
     
-    return detections;
+    uint32_t post_end = get_cycle_count();
+    float postprocess_ms = (post_end - post_start) / (float)(SystemCoreClock / 1000);
+    total_postprocess_time_ += postprocess_ms;
+    
+    printf("[YOLO] Detected %d persons (%.1f ms, post-process %.2f ms)\n",
+           count, inference_ms, postprocess_ms);
+    
+    return count;
 }
 
 void YoloPoseDetector::printStats() const {
@@ -556,5 +623,10 @@ void YoloPoseDetector::printStats() const {
         printf("[YOLO] Statistics:\n");
         printf("  Total inferences: %d\n", total_inferences_);
         printf("  Average time: %.2f ms\n", total_inference_time_ / total_inferences_);
+        printf("  Average post-process time: %.2f ms\n", total_postprocess_time_ / total_inferences_);
+        printf("  Average candidates above threshold: %.1f\n", (float)total_candidates_ / total_inferences_);
+        printf("  Average NMS IoU evaluations: %.1f\n", (float)total_nms_iou_evals_ / total_inferences_);
+        npu_pmu_print(npu_pmu_, total_inferences_, total_inference_time_ / total_inferences_);
+        yolo_op_profiler.printReport();
     }
 }
\ No newline at end of file
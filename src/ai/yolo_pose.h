@@ -4,9 +4,16 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <vector>
+#include "image_utils.h"
+#include "npu_pmu.h"
 
+// 輸入尺寸可由 CMake (YOLO_INPUT_SIZE) 覆寫，例如 320 或 416 的模型
+#ifndef YOLO_INPUT_WIDTH
 #define YOLO_INPUT_WIDTH  256
+#endif
+#ifndef YOLO_INPUT_HEIGHT
 #define YOLO_INPUT_HEIGHT 256
+#endif
 #define NUM_KEYPOINTS 17
 
 // YOLOv8 使用 3 個尺度: 8, 16, 32
@@ -19,6 +26,24 @@
                             (YOLO_INPUT_WIDTH/16)*(YOLO_INPUT_HEIGHT/16) + \
                             (YOLO_INPUT_WIDTH/32)*(YOLO_INPUT_HEIGHT/32))
 
+#define YOLO_NUM_OUTPUTS 7
+#define YOLO_NUM_SCALES  3
+#define YOLO_DFL_BINS    16
+
+// NMS 上限: 排序前只保留分數最高的 TOP_K 個候選，並限制每幀輸出數量
+#define YOLO_NMS_TOP_K        128
+#define YOLO_MAX_DETECTIONS   32
+
+// 預設使用保持長寬比的 letterbox 前處理 (可透過 setLetterboxEnabled() 切換)
+#ifndef YOLO_USE_LETTERBOX
+#define YOLO_USE_LETTERBOX 1
+#endif
+
+// DFL 解碼預設使用查表路徑 (可透過 setDflLutEnabled() 切回浮點路徑驗證)
+#ifndef YOLO_DFL_USE_LUT
+#define YOLO_DFL_USE_LUT 1
+#endif
+
 struct Box {
     float x, y, w, h;  // Bounding box (x,y 為左上角，像素座標)
 };
@@ -35,16 +60,64 @@ struct PersonDetection {
     HumanPose keypoints[NUM_KEYPOINTS];
 };
 
+// 輸出張量的量化參數 (init() 時快取，避免每個元素都經由 TfLiteAffineQuantization 讀取)
+struct YoloOutputQuant {
+    const int8_t* data;
+    int row_size;          // dims[2]
+    float scale;
+    int32_t zero_point;
+};
+
+// 單一尺度的後處理設定
+struct YoloScaleLevel {
+    int stride;
+    int conf_output;           // confidence 輸出索引
+    int bbox_output;           // bbox 輸出索引
+    int anchor_offset;         // 在合併 anchor 序列中的起點
+    int num_anchors;
+    int32_t conf_threshold_q;  // 等效於 MODEL_SCORE_THRESHOLD 的 int8 門檻 (128 表示全部拒絕)
+    const float* dfl_exp_lut;  // exp(-d * scale), d = max_q - q ∈ [0, 255]
+};
+
+// 每幀後處理的暫存區 (隨 detector 一起配置，穩態下不使用 heap)
+struct YoloScratch {
+    Box boxes[YOLO_TOTAL_ANCHORS];
+    float scores[YOLO_TOTAL_ANCHORS];
+    int anchor_ids[YOLO_TOTAL_ANCHORS];     // keypoints 延後到 NMS 之後才解碼
+    int nms_order[YOLO_TOTAL_ANCHORS];
+    int nms_result[YOLO_MAX_DETECTIONS];
+    uint32_t nms_suppressed[(YOLO_NMS_TOP_K + 31) / 32];
+};
+
 class YoloPoseDetector {
 public:
     YoloPoseDetector();
-    ~YoloPoseDetector();
+    ~YoloPoseDetector() = default;
     
     bool init(const void* model_data, size_t model_size);
     std::vector<PersonDetection> detect(const uint8_t* image, int width, int height);
     
+    // 不配置記憶體的版本: 結果寫入呼叫端提供的陣列，回傳偵測數量
+    int detect(const uint8_t* image, int width, int height,
+               PersonDetection* results, int max_results);
+    
     void printStats() const;
     
+    // 切換 DFL 查表 / 浮點解碼路徑
+    void setDflLutEnabled(bool enable) { use_dfl_lut_ = enable; }
+    
+    // 切換 letterbox / 非等比縮放前處理
+    void setLetterboxEnabled(bool enable) { use_letterbox_ = enable; }
+    
+    // 最近一幀的模型輸入 -> 原始影像座標轉換 (bbox 與 keypoints 皆適用)
+    const ImageTransform& getInputTransform() const { return input_transform_; }
+    
+    // 最近一幀 NMS 所做的 IoU 計算次數
+    uint32_t getLastNmsIouCount() const { return last_nms_iou_evals_; }
+    
+    // 兩個 bounding box 的 IoU (NMS 與追蹤器共用)
+    static float boxIou(const Box& a, const Box& b);
+    
 private:
     void* interpreter_;
     void* input_tensor_;
@@ -52,33 +125,46 @@ private:
     
     int total_inferences_;
     float total_inference_time_;
+    float total_postprocess_time_;
+    int total_candidates_;
+    NpuPmuCounters npu_pmu_;   // NPU_PMU_CAPTURE 開啟時累計
+    
+    // int8 域後處理
+    YoloOutputQuant output_quant_[YOLO_NUM_OUTPUTS];
+    YoloScaleLevel scale_levels_[YOLO_NUM_SCALES];
+    float (*dfl_exp_lut_)[256];   // 指向靜態 LUT (位置由 MEM_PLACE_LUTS 決定)
+    bool use_dfl_lut_;
+    bool use_letterbox_;
+    ImageTransform input_transform_;
     
-    // Anchor 和 Stride 矩陣（預先計算）
-    float* stride_array_;      // [total_anchors_]
-    float** anchor_array_;     // [total_anchors_][2]
-    int total_anchors_;        // 實際的 anchor 總數
-    int out_dim_size_[3];      // 各尺度的累積大小邊界
+    YoloScratch scratch_;
+    uint32_t last_nms_iou_evals_;
+    uint32_t total_nms_iou_evals_;
     
     void preprocessImage(const uint8_t* image, int width, int height);
-    std::vector<PersonDetection> parseOutput();
+    int parseOutput(PersonDetection* results, int max_results);
     
     // YOLOv8 後處理函數
-    void initAnchorsAndStrides();
-    void freeAnchorsAndStrides();
+    bool initOutputQuant();
+    int32_t computeConfThreshold(const YoloOutputQuant& conf) const;
+    void initDflLut(const YoloOutputQuant& bbox, float* lut) const;
     
-    float sigmoid(float x);
+    float sigmoid(float x) const;
     void softmax(float* input, size_t len);
     
-    float dequantize(int8_t value, float scale, int32_t zero_point);
-    float getBboxDequantValue(int dim1, int dim2, void* tensor);
-    float getKeypointDequantValue(int dim1, int dim2, void* tensor, 
-                                   float anchor0, float anchor1, float stride);
-    void calculateXYWH(int j, void** outputs, Box* bbox, int* out_dim_size);
+    float dequantize(int8_t value, float scale, int32_t zero_point) const;
+    float getBboxDequantValue(int dim1, int dim2, const YoloOutputQuant& out) const;
+    float getKeypointDequantValue(int dim1, int dim2, const YoloOutputQuant& out,
+                                   float anchor0, float anchor1, float stride) const;
+    float decodeDflFloat(int local_idx, int k, const YoloOutputQuant& out);
+    float decodeDflLut(const int8_t* bins, const float* lut) const;
+    void calculateXYWH(const YoloScaleLevel& level, int local_idx, int j, Box* bbox);
+    void decodeKeypoints(int anchor_idx, HumanPose* kpts) const;
     
     // NMS
-    float boxIou(const Box& a, const Box& b);
-    void nmsBoxes(std::vector<Box>& boxes, std::vector<float>& confidences,
-                  float scoreThreshold, float nmsThreshold, std::vector<int>& result);
+    int nmsBoxes(const Box* boxes, const float* confidences, int count,
+                 float scoreThreshold, float nmsThreshold,
+                 int maxDetections, int* result);
 };
 
 #endif // YOLO_POSE_H
\ No newline at end of file
@@ -1,18 +1,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <algorithm>
 
 #include "vsi_video.h"
 #include "yolo_pose.h"
 #include "reid.h"
+#include "tracker.h"
 #include "image_utils.h"
 #include "draw_utils.h"
 #include "lcd_display.h"
+#include "heap_stats.h"
+#include "profiler.h"
+#include "tensor_arena.h"
+#include "mem_placement.h"
+#include "npu_hooks.h"
+#if !defined(HOST_BUILD)
 #include <ethosu_driver.h>
 #include "CMSIS_5/Device/ARM/ARMCM55/Include/ARMCM55.h"
 
 extern "C" void initialise_monitor_handles(void);
+#endif
+extern "C" uint32_t SystemCoreClock;
 
+#if !defined(HOST_BUILD)
 // Ethos-U55 Base Address on Corstone-300
 #define ETHOSU_BASE_ADDRESS 0x48102000
 #define ETHOSU_IRQ 56
@@ -36,6 +48,14 @@ void ethosu_init_driver() {
     
     NVIC_EnableIRQ((IRQn_Type)ETHOSU_IRQ);
 }
+#else
+// Host build: NPU op 由 src/platform/host/ethosu_host.cc 重播錄製輸出
+static void initialise_monitor_handles(void) {}
+
+void ethosu_init_driver() {
+    printf("Host build: Ethos-U ops replay recorded outputs\n");
+}
+#endif
 
 // 模型資料宣告 (由 tflite_to_cc.py 生成的 .cc 檔案提供定義)
 extern "C" {
@@ -48,53 +68,152 @@ extern "C" {
 // 全域物件
 static YoloPoseDetector* yolo_detector = nullptr;
 static ReIDMatcher* reid_matcher = nullptr;
+static Tracker* tracker = nullptr;
 static VSIVideoController* video_controller = nullptr;
 static VSIVideoOutput* video_output = nullptr;
 static LCDDisplay* lcd_display = nullptr;
 
-// 處理單幀並繪製結果
-void processFrame(uint8_t* frame, int frame_number) {
-    printf("\n========== Frame %d ==========\n", frame_number);
+// 管線模式: 第 N+1 幀的 YOLO 在 NPU 上推論時，CPU 完成第 N 幀的匹配、繪製與輸出
+#ifndef APP_PIPELINE_FRAMES
+#define APP_PIPELINE_FRAMES 1
+#endif
 
-    // Step 1: YOLO 偵測人物
-    auto detections = yolo_detector->detect(frame, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT);
+// Gallery 存檔 (啟動時載入、結束時儲存)，可由第二個參數覆寫
+#define REID_GALLERY_FILE "reid_gallery.bin"
+
+// Re-ID 裁切依骨架關鍵點決定 (關閉時使用 YOLO bbox)
+#ifndef REID_POSE_CROP
+#define REID_POSE_CROP 1
+#endif
+
+#define REID_KEYPOINT_THRESHOLD   0.5f   // 關鍵點視為可見的分數
+#define REID_MIN_VISIBLE_KPTS     6      // 可見關鍵點不足時不做 Re-ID
+
+// COCO 關鍵點索引
+enum {
+    KPT_NOSE = 0, KPT_L_SHOULDER = 5, KPT_R_SHOULDER = 6,
+    KPT_L_HIP = 11, KPT_R_HIP = 12, KPT_L_ANKLE = 15, KPT_R_ANKLE = 16
+};
+
+// 每幀狀態 (雙緩衝: 一份正在分析，另一份等待完成)
+struct FrameState {
+    uint8_t* frame;
+    int frame_number;
+    int num_detections;
+    ImageTransform transform;     // 複製一份，偵測器的轉換會被下一幀覆寫
+    bool finished;                // finishFrame() 已執行 (NPU idle task 或補做)
+    PersonDetection detections[YOLO_MAX_DETECTIONS];
+    TrackResult tracks[YOLO_MAX_DETECTIONS];
+    int person_ids[YOLO_MAX_DETECTIONS];   // 追蹤沿用或 Re-ID 匹配的結果 (-1 表示未知)
+    int num_rois;
+    int reid_det_index[YOLO_MAX_DETECTIONS];
+    bool reid_valid[YOLO_MAX_DETECTIONS];
+    float reid_features[YOLO_MAX_DETECTIONS][REID_FEATURE_DIM];
+};
+
+// 每幀使用的固定緩衝區 (避免穩態下的 heap 配置)
+static uint8_t frame_buffers[2][VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * 3] __attribute__((section(".ddr_data"), aligned(16)));
+static FrameState frame_states[2] __attribute__((section(".ddr_data"), aligned(16)));
+static uint8_t display_frame[VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * 3] __attribute__((section(".ddr_data"), aligned(16)));
+
+// --wrap=malloc 確實生效時才輸出 [Heap] 計數
+static bool heap_stats_valid = false;
+
+// 批次 Re-ID 的輸入 ROI (只在分析階段使用)
+static ImageView reid_rois[YOLO_MAX_DETECTIONS];
+
+// computeReidCrop() 的結果 (不做 Re-ID 的原因由呼叫端每幀彙總輸出)
+enum ReidCropResult {
+    REID_CROP_OK,
+    REID_CROP_FEW_KEYPOINTS,     // 可見關鍵點少於 REID_MIN_VISIBLE_KPTS
+    REID_CROP_NO_TORSO,          // 缺少肩膀或臀部，無法估計軀幹長度
+};
+
+// 計算 Re-ID 裁切區域 (YOLO 輸入座標)
+static ReidCropResult computeReidCrop(const PersonDetection& det, Box* crop) {
+#if REID_POSE_CROP
+    const HumanPose* kpts = det.keypoints;
+    float min_x = 1e9f, min_y = 1e9f, max_x = -1e9f, max_y = -1e9f;
+    int visible = 0;
+    for (int k = 0; k < NUM_KEYPOINTS; k++) {
+        if (kpts[k].score <= REID_KEYPOINT_THRESHOLD) continue;
+        float x = (float)kpts[k].x, y = (float)kpts[k].y;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+        visible++;
+    }
     
-    if (detections.empty()) {
-        printf("No persons detected\n");
-        // 即使沒有偵測到人，也發送原始幀
-        if (video_output) {
-            video_output->sendFrame(frame);
-        }
-        return;
+    // 需要至少一側肩膀與一側臀部才能估計軀幹長度
+    int shoulder = kpts[KPT_L_SHOULDER].score > kpts[KPT_R_SHOULDER].score ? KPT_L_SHOULDER : KPT_R_SHOULDER;
+    int hip = kpts[KPT_L_HIP].score > kpts[KPT_R_HIP].score ? KPT_L_HIP : KPT_R_HIP;
+    if (visible < REID_MIN_VISIBLE_KPTS) {
+        return REID_CROP_FEW_KEYPOINTS;
+    }
+    if (kpts[shoulder].score <= REID_KEYPOINT_THRESHOLD ||
+        kpts[hip].score <= REID_KEYPOINT_THRESHOLD) {
+        return REID_CROP_NO_TORSO;
     }
+    float torso = fabsf((float)kpts[hip].y - (float)kpts[shoulder].y);
+    torso = std::max(torso, det.bbox.h * 0.2f);
     
-    // 計算縮放比例 (YOLO 輸入到原始影像)
-    float scale_x = (float)VSI_VIDEO_WIDTH / YOLO_INPUT_WIDTH;
-    float scale_y = (float)VSI_VIDEO_HEIGHT / YOLO_INPUT_HEIGHT;
+    // 邊界: 頭部在肩膀/鼻子上方，腳在腳踝下方，左右留衣物與手臂的空間
+    float top = min_y - torso * (kpts[KPT_NOSE].score > REID_KEYPOINT_THRESHOLD ? 0.3f : 0.6f);
+    float bottom = max_y + torso * 0.15f;
+    bool ankles_visible = kpts[KPT_L_ANKLE].score > REID_KEYPOINT_THRESHOLD ||
+                          kpts[KPT_R_ANKLE].score > REID_KEYPOINT_THRESHOLD;
+    if (!ankles_visible) {
+        // 腿部未偵測到時沿用 bbox 底部，避免截掉下半身
+        bottom = std::max(bottom, det.bbox.y + det.bbox.h);
+    }
+    float margin_x = torso * 0.3f;
+    crop->x = min_x - margin_x;
+    crop->y = top;
+    crop->w = (max_x + margin_x) - crop->x;
+    crop->h = bottom - top;
+#else
+    *crop = det.bbox;
+#endif
+    return REID_CROP_OK;
+}
+
+// 收集需要 Re-ID 的人物區域 (追蹤中的人物與姿態不足者略過)
+static void collectReidRois(FrameState* st) {
+    PROFILE_SCOPE(PROF_REID_CROP);
     
-    // 創建繪圖用的幀副本
-    uint8_t* display_frame = new uint8_t[VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * 3];
-    memcpy(display_frame, frame, VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * 3);
-    
-    // Step 2: 對每個偵測到的人進行 Re-ID
-    for (size_t i = 0; i < detections.size(); i++) {
-        printf("\n--- Person %zu/%zu ---\n", i + 1, detections.size());
-        printf("BBox: (%.1f, %.1f, %.1f, %.1f), Conf: %.3f\n",
-               detections[i].bbox.x, detections[i].bbox.y,
-               detections[i].bbox.w, detections[i].bbox.h,
-               detections[i].confidence);
+    const ImageTransform& transform = st->transform;
+    int few_keypoints = 0;
+    int no_torso = 0;
+    for (int i = 0; i < st->num_detections; i++) {
+        const Box& bbox = st->detections[i].bbox;
+        const TrackResult& track = st->tracks[i];
+        printf("\n--- Person %d/%d ---\n", i + 1, st->num_detections);
+        printf("BBox: (%.1f, %.1f, %.1f, %.1f), Conf: %.3f, Track: %d\n",
+               bbox.x, bbox.y, bbox.w, bbox.h, st->detections[i].confidence, track.track_id);
         
-        // bbox 已經是像素座標了
-        int x1 = (int)detections[i].bbox.x;
-        int y1 = (int)detections[i].bbox.y;
-        int x2 = (int)(detections[i].bbox.x + detections[i].bbox.w);
-        int y2 = (int)(detections[i].bbox.y + detections[i].bbox.h);
+        st->person_ids[i] = track.person_id;
+        if (!track.needs_reid) {
+            printf("Tracked as Person ID %d, skipping Re-ID\n", track.person_id);
+            continue;
+        }
+        
+        Box crop;
+        ReidCropResult crop_result = computeReidCrop(st->detections[i], &crop);
+        if (crop_result == REID_CROP_FEW_KEYPOINTS) {
+            few_keypoints++;
+            continue;
+        }
+        if (crop_result == REID_CROP_NO_TORSO) {
+            no_torso++;
+            continue;
+        }
         
         // 將座標從 YOLO 輸入尺寸映射到原始影像尺寸
-        x1 = (int)(x1 * scale_x);
-        y1 = (int)(y1 * scale_y);
-        x2 = (int)(x2 * scale_x);
-        y2 = (int)(y2 * scale_y);
+        int x1 = (int)transform.toSourceX(crop.x);
+        int y1 = (int)transform.toSourceY(crop.y);
+        int x2 = (int)transform.toSourceX(crop.x + crop.w);
+        int y2 = (int)transform.toSourceY(crop.y + crop.h);
         
         // 邊界檢查
         x1 = (x1 < 0) ? 0 : x1;
@@ -110,65 +229,189 @@ void processFrame(uint8_t* frame, int frame_number) {
             continue;
         }
         
-        // 裁切人物區域
-        uint8_t* cropped = new uint8_t[crop_w * crop_h * 3];
-        ImageUtils::crop(frame, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT,
-                        cropped, x1, y1, crop_w, crop_h);
+        // 人物區域 (直接指向原始幀，不複製)
+        ImageView person_roi = {st->frame, VSI_VIDEO_WIDTH * 3, x1, y1, crop_w, crop_h};
+        reid_rois[st->num_rois] = person_roi;
+        st->reid_det_index[st->num_rois] = i;
+        st->num_rois++;
+    }
+    
+    if (few_keypoints + no_torso > 0) {
+        printf("Re-ID skipped on pose: %d with < %d keypoints, %d without shoulder/hip\n",
+               few_keypoints, REID_MIN_VISIBLE_KPTS, no_torso);
+    }
+}
+
+// 階段一: YOLO 偵測 + 批次 Re-ID 特徵提取 (需要 NPU)
+void analyzeFrame(FrameState* st) {
+    printf("\n========== Frame %d ==========\n", st->frame_number);
+    st->finished = false;
+
+    // Step 1: YOLO 偵測人物
+    uint32_t allocs_before = HeapStats::allocCount();
+    st->num_detections = yolo_detector->detect(st->frame, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT,
+                                               st->detections, YOLO_MAX_DETECTIONS);
+    if (heap_stats_valid) {
+        printf("[Heap] YOLO detect: %lu allocations\n",
+               (unsigned long)(HeapStats::allocCount() - allocs_before));
+    }
+    
+    // YOLO 輸入座標 -> 原始影像座標 (letterbox 或非等比縮放)
+    st->transform = yolo_detector->getInputTransform();
+    st->num_rois = 0;
+    
+    if (st->num_detections == 0) {
+        // 空白幀也要讓軌跡預測並累計 miss，否則過期軌跡不會被刪除
+        {
+            PROFILE_SCOPE(PROF_TRACK);
+            tracker->update(st->detections, 0, st->frame_number, st->tracks);
+        }
+        printf("No persons detected\n");
+        return;
+    }
+    
+    // Step 2: 追蹤，決定哪些人物需要 Re-ID
+    {
+        PROFILE_SCOPE(PROF_TRACK);
+        tracker->update(st->detections, st->num_detections, st->frame_number, st->tracks);
+    }
+    
+    // Step 3: 收集需要 Re-ID 的人物區域
+    collectReidRois(st);
+    
+    // Step 4: 批次 Re-ID 特徵提取 (CPU 前處理與 NPU 推論重疊)
+    reid_matcher->extractFeaturesBatch(reid_rois, st->num_rois, st->reid_features, st->reid_valid);
+}
+
+// 在顯示幀上繪製有 ID 的人物並輸出骨架關鍵點
+static void drawFrame(const FrameState* st) {
+    PROFILE_SCOPE(PROF_DRAW);
+    
+    const ImageTransform& transform = st->transform;
+    for (int i = 0; i < st->num_detections; i++) {
+        int person_id = st->person_ids[i];
+        if (person_id < 0) continue;
         
-        // Re-ID 特徵提取
-        float features[REID_FEATURE_DIM];
-        if (reid_matcher->extractFeatures(cropped, crop_w, crop_h, features)) {
-            // 匹配或加入 Gallery
-            int person_id = reid_matcher->matchInGallery(features, frame_number);
-            
-            if (person_id < 0) {
-                person_id = reid_matcher->addToGallery(features, frame_number);
-            }
-            
-            printf(">>> FINAL RESULT: Person ID = %d <<<\n", person_id);
-            
-            // Print ReID Vector (First 10 elements)
-            printf("ReID Vector (first 10/512): [");
-            for(int v=0; v<10; v++) printf("%.4f ", features[v]);
-            printf("...]\n");
-
-            // 繪製偵測結果到顯示幀
-            if (display_frame) {
-                DrawUtils::drawDetection(display_frame, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT,
-                                        detections[i], person_id, scale_x, scale_y);
-            }
-            
-            // 輸出骨架關鍵點
-            printf("Pose Keypoints:\n");
-            const char* kpt_names[] = {"Nose", "LEye", "REye", "LEar", "REar", "LShldr", "RShldr", "LElbow", "RElbow", "LWrist", "RWrist", "LHip", "RHip", "LKnee", "RKnee", "LAnkle", "RAnkle"};
-            int visible_keypoints = 0;
-            for (int k = 0; k < NUM_KEYPOINTS; k++) {
-                if (detections[i].keypoints[k].score > 0.5f) {
-                    visible_keypoints++;
-                    printf("  %-6s: (%3d, %3d) score=%.2f\n", kpt_names[k], 
-                           (int)detections[i].keypoints[k].x, (int)detections[i].keypoints[k].y, 
-                           detections[i].keypoints[k].score);
-                }
+        const PersonDetection& det = st->detections[i];
+        printf("\n--- Frame %d, Person %d/%d ---\n", st->frame_number, i + 1, st->num_detections);
+        printf(">>> FINAL RESULT: Person ID = %d (%s) <<<\n", person_id,
+               st->tracks[i].needs_reid ? "Re-ID" : "tracked");
+
+        // 繪製偵測結果到顯示幀
+        DrawUtils::drawDetection(display_frame, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT,
+                                det, person_id, transform);
+        
+        // 輸出骨架關鍵點
+        printf("Pose Keypoints:\n");
+        const char* kpt_names[] = {"Nose", "LEye", "REye", "LEar", "REar", "LShldr", "RShldr", "LElbow", "RElbow", "LWrist", "RWrist", "LHip", "RHip", "LKnee", "RKnee", "LAnkle", "RAnkle"};
+        int visible_keypoints = 0;
+        for (int k = 0; k < NUM_KEYPOINTS; k++) {
+            if (det.keypoints[k].score > 0.5f) {
+                visible_keypoints++;
+                printf("  %-6s: (%3d, %3d) score=%.2f\n", kpt_names[k], 
+                       (int)transform.toSourceX((float)det.keypoints[k].x),
+                       (int)transform.toSourceY((float)det.keypoints[k].y),
+                       det.keypoints[k].score);
             }
-            printf("Keypoints: %d/%d visible\n", visible_keypoints, NUM_KEYPOINTS);
         }
+        printf("Keypoints: %d/%d visible\n", visible_keypoints, NUM_KEYPOINTS);
+    }
+}
+
+// 階段二: Gallery 匹配、繪製與輸出 (純 CPU，可與下一幀的 YOLO 推論重疊)
+void finishFrame(FrameState* st) {
+    st->finished = true;
+    
+    if (st->num_detections == 0) {
+        // 即使沒有偵測到人，也發送原始幀
+        if (video_output) {
+            PROFILE_SCOPE(PROF_OUTPUT);
+            video_output->sendFrame(st->frame);
+        }
+        return;
+    }
+    
+    // 創建繪圖用的幀副本
+    memcpy(display_frame, st->frame, VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * 3);
+    
+    // Step 5: 整幀一對一匹配，結果寫回追蹤器
+    // 未做 Re-ID (或特徵提取失敗) 的人物沿用追蹤 ID，這些 ID 不參與本幀指派
+    bool queried[YOLO_MAX_DETECTIONS] = {};
+    for (int r = 0; r < st->num_rois; r++) {
+        if (st->reid_valid[r]) queried[st->reid_det_index[r]] = true;
+    }
+    int held_ids[YOLO_MAX_DETECTIONS];
+    int num_held = 0;
+    for (int i = 0; i < st->num_detections; i++) {
+        if (!queried[i] && st->person_ids[i] >= 0) held_ids[num_held++] = st->person_ids[i];
+    }
+    
+    int reid_ids[YOLO_MAX_DETECTIONS];
+    {
+        PROFILE_SCOPE(PROF_MATCH);
+        reid_matcher->matchFrame(st->reid_features, st->reid_valid, st->num_rois,
+                                 st->frame_number, reid_ids, held_ids, num_held);
+    }
+    
+    for (int r = 0; r < st->num_rois; r++) {
+        if (!st->reid_valid[r]) continue;
         
-        delete[] cropped;
+        int i = st->reid_det_index[r];
+        st->person_ids[i] = reid_ids[r];
+        tracker->setPersonId(st->tracks[i].track_id, reid_ids[r], st->frame_number);
+        
+        // Print ReID Vector (First 10 elements)
+        const float* features = st->reid_features[r];
+        printf("Frame %d, Person %d ReID Vector (first 10/512): [", st->frame_number, i + 1);
+        for(int v=0; v<10; v++) printf("%.4f ", features[v]);
+        printf("...]\n");
     }
     
+    // Step 6: 繪製與輸出 (含追蹤沿用 ID 的人物)
+    drawFrame(st);
+    
     // 顯示帶有標註的幀到 LCD
-    if (lcd_display && display_frame) {
+    if (lcd_display) {
+        PROFILE_SCOPE(PROF_LCD);
         lcd_display->displayFrame(display_frame, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT);
     }
 
     // 發送帶有標註的幀到 VSI 輸出
-    if (video_output && display_frame) {
+    if (video_output) {
+        PROFILE_SCOPE(PROF_OUTPUT);
         video_output->sendFrame(display_frame);
     }
-    
-    if (display_frame) {
-        delete[] display_frame;
+}
+
+// NPU idle task 包裝 (在 YOLO Invoke 等待 NPU 中斷時執行)
+static void finishFrameTask(void* ctx) {
+    finishFrame(static_cast<FrameState*>(ctx));
+}
+
+// 處理單幀: 分析本幀，並在 YOLO 推論期間完成上一幀 (pending)
+// 回傳本幀狀態，作為下一次呼叫的 pending
+FrameState* processFrame(FrameState* current, FrameState* pending) {
+#if APP_PIPELINE_FRAMES
+    if (pending) {
+        npu_set_idle_task(finishFrameTask, pending);
     }
+    analyzeFrame(current);
+    // finishFrameTask 可能沒有執行: YOLO Invoke 未等待 NPU (例如推論失敗)，
+    // 或尚未執行就被 Re-ID 批次的 staging 工作取代。npu_clear_idle_task()
+    // 的回傳值屬於最後登記的工作，因此以 FrameState 的旗標判斷
+    if (pending) {
+        npu_clear_idle_task();
+        if (!pending->finished) {
+            finishFrame(pending);
+        }
+    }
+    return current;
+#else
+    (void)pending;
+    analyzeFrame(current);
+    finishFrame(current);
+    return nullptr;
+#endif
 }
 
 int main(int argc, char* argv[]) {
@@ -176,7 +419,13 @@ int main(int argc, char* argv[]) {
     // setvbuf(stdout, NULL, _IONBF, 0); // Disable buffering
     setvbuf(stdout, NULL, _IOLBF, 1024); // Enable line buffering
     printf("Application started.\n");
+    Profiler::init();
     ethosu_init_driver();
+    
+    heap_stats_valid = HeapStats::verifyWrap();
+    if (!heap_stats_valid) {
+        printf("Warning: malloc wrapper not active (--wrap under LTO?), heap counts disabled\n");
+    }
 
     printf("\n");
     printf("========================================\n");
@@ -190,7 +439,13 @@ int main(int argc, char* argv[]) {
         video_path = argv[1];
     }
     
-    printf("Video input: %s\n\n", video_path);
+    const char* gallery_path = REID_GALLERY_FILE;
+    if (argc > 2) {
+        gallery_path = argv[2];
+    }
+    
+    printf("Video input: %s\n", video_path);
+    printf("Gallery file: %s\n\n", gallery_path);
     
     // 初始化 VSI 視訊控制器 (Input)
     video_controller = new VSIVideoController(video_path);
@@ -222,6 +477,20 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
+    TensorArena::printReport();
+    
+    MemPlacement::record("frame buffers", frame_buffers, sizeof(frame_buffers));
+    MemPlacement::record("display frame", display_frame, sizeof(display_frame));
+    MemPlacement::printReport();
+    
+    // 載入上次執行的 Gallery (warm start)
+    if (!reid_matcher->loadGallery(gallery_path)) {
+        printf("No gallery loaded, starting empty\n");
+    }
+    
+    // 初始化追蹤器
+    tracker = new Tracker();
+    
     // 初始化 LCD 顯示
     lcd_display = new LCDDisplay();
     if (!lcd_display->init()) {
@@ -236,14 +505,33 @@ int main(int argc, char* argv[]) {
     printf(" System initialized, starting processing...\n");
     printf("========================================\n");
     
-    // 分配幀緩衝區
-    uint8_t* frame_buffer = new uint8_t[VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * 3];
-    
-    // 處理影片
+    // 處理影片 (兩組幀緩衝區輪替: 擷取第 N+1 幀時第 N 幀仍待完成)
     int frame_count = 0;
+    FrameState* pending = nullptr;
+    float total_ms = 0.0f;
     while (video_controller->hasMoreFrames()) {
-        if (video_controller->getNextFrame(frame_buffer)) {
-            processFrame(frame_buffer, frame_count);
+        FrameState* current = &frame_states[frame_count & 1];
+        current->frame = frame_buffers[frame_count & 1];
+        current->frame_number = frame_count;
+        
+        uint64_t start_cycles = Profiler::now();
+        bool captured;
+        {
+            PROFILE_SCOPE(PROF_CAPTURE);
+            captured = video_controller->getNextFrame(current->frame);
+        }
+        if (captured) {
+            uint32_t allocs_before = HeapStats::allocCount();
+            
+            pending = processFrame(current, pending);
+            
+            if (heap_stats_valid) {
+                printf("[Heap] Frame %d: %lu allocations\n", frame_count,
+                       (unsigned long)(HeapStats::allocCount() - allocs_before));
+            }
+            uint64_t frame_cycles = Profiler::now() - start_cycles;
+            PROFILE_RECORD(PROF_FRAME, frame_cycles);
+            total_ms += (float)frame_cycles / (SystemCoreClock / 1000);
             frame_count++;
             
             // 可選:限制處理幀數
@@ -251,24 +539,41 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // 完成管線中最後一幀
+    if (pending) {
+        finishFrame(pending);
+    }
+    
     // 輸出統計資訊
     printf("\n========================================\n");
     printf(" Processing Complete\n");
     printf("========================================\n");
-    printf("Total frames processed: %d\n\n", frame_count);
+    printf("Total frames processed: %d\n", frame_count);
+    printf("Pipeline mode: %s\n", APP_PIPELINE_FRAMES ? "on" : "off");
+    if (frame_count > 0 && total_ms > 0.0f) {
+        printf("Throughput: %.2f FPS (%.2f ms/frame)\n\n",
+               frame_count * 1000.0f / total_ms, total_ms / frame_count);
+    }
     
     yolo_detector->printStats();
     printf("\n");
     reid_matcher->printStats();
     printf("\n");
+    tracker->printStats();
+    printf("\n");
+#if APP_PROFILING
+    Profiler::printReport();
+    printf("\n");
+#endif
     reid_matcher->printGallery();
+    reid_matcher->saveGallery(gallery_path);
     
     // 清理
-    delete[] frame_buffer;
     delete video_controller;
     delete video_output;
     delete yolo_detector;
     delete reid_matcher;
+    delete tracker;
     if (lcd_display) delete lcd_display;
     
     printf("\nDone!\n");
@@ -0,0 +1,121 @@
+/*
+ * ethosu_host.cc - Host build 的 Ethos-U custom op 替代
+ *
+ * Vela 編譯後的模型把大部分運算包成單一 "ethos-u" custom op (NPU command
+ * stream)，CPU reference kernel 無法執行。Host build 以錄製的輸出 tensor
+ * 重播取代: 第 k 個被初始化的 ethos-u op 的第 i 個輸出依序從
+ *   <NPU_REPLAY_DIR>/op<k>_out<i>.bin
+ * 讀取 (每次 Invoke 讀一個 tensor 大小，讀到檔尾後從頭重播)。
+ * 找不到錄製檔時輸出填 -128 (int8 最小值)，後處理會得到「無偵測」。
+ * 其餘 CPU op (如 quantize / dequantize) 仍由 TFLM reference kernel 執行。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "npu_hooks.h"
+
+#ifndef NPU_REPLAY_DIR
+#define NPU_REPLAY_DIR "npu_replay"
+#endif
+
+#define NPU_REPLAY_MAX_OUTPUTS 8
+#define NPU_REPLAY_PATH_MAX 256
+
+namespace tflite {
+
+namespace {
+
+struct ReplayOp {
+    int index;
+    FILE* files[NPU_REPLAY_MAX_OUTPUTS];
+    bool warned;
+};
+
+int replay_op_count = 0;
+
+const char* ReplayDir() {
+    const char* dir = getenv("NPU_REPLAY_DIR");
+    return dir ? dir : NPU_REPLAY_DIR;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+    ReplayOp* op = static_cast<ReplayOp*>(
+        context->AllocatePersistentBuffer(context, sizeof(ReplayOp)));
+    if (op == nullptr) return nullptr;
+    
+    op->index = replay_op_count++;
+    op->warned = false;
+    
+    char path[NPU_REPLAY_PATH_MAX];
+    for (int i = 0; i < NPU_REPLAY_MAX_OUTPUTS; i++) {
+        snprintf(path, sizeof(path), "%s/op%d_out%d.bin", ReplayDir(), op->index, i);
+        op->files[i] = fopen(path, "rb");
+    }
+    
+    printf("[NPU Host] ethos-u op %d: replaying from %s\n", op->index, ReplayDir());
+    return op;
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+    if (node->outputs->size > NPU_REPLAY_MAX_OUTPUTS) {
+        MicroPrintf("ethos-u replay supports at most %d outputs", NPU_REPLAY_MAX_OUTPUTS);
+        return kTfLiteError;
+    }
+    return kTfLiteOk;
+}
+
+bool ReadReplay(FILE* f, uint8_t* data, size_t bytes) {
+    if (f == nullptr) return false;
+    
+    size_t n = fread(data, 1, bytes, f);
+    if (n < bytes) {
+        // 檔尾: 從頭重播
+        fseek(f, 0, SEEK_SET);
+        n = fread(data, 1, bytes, f);
+    }
+    return n == bytes;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+    ReplayOp* op = static_cast<ReplayOp*>(node->user_data);
+    
+    // 真實 NPU 上 CPU 會在等待中斷時執行登記的工作，這裡在「推論」前執行
+    npu_run_idle_task();
+    
+    for (int i = 0; i < node->outputs->size; i++) {
+        TfLiteEvalTensor* output = micro::GetEvalOutput(context, node, i);
+        size_t bytes = 0;
+        TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(output, &bytes));
+        uint8_t* data = static_cast<uint8_t*>(output->data.data);
+        
+        if (!ReadReplay(op->files[i], data, bytes)) {
+            if (!op->warned) {
+                printf("[NPU Host] Warning: no replay data for op %d output %d (%u bytes), filling -128\n",
+                       op->index, i, (unsigned)bytes);
+                op->warned = true;
+            }
+            memset(data, 0x80, bytes);
+        }
+    }
+    
+    return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration* Register_ETHOSU() {
+    static TFLMRegistration r = micro::RegisterOp(Init, Prepare, Eval);
+    return &r;
+}
+
+const char* GetString_ETHOSU() {
+    return "ethos-u";
+}
+
+}  // namespace tflite
@@ -0,0 +1,25 @@
+/*
+ * host_lcd.cpp - Host build 的 LCDDisplay
+ *
+ * Host 上沒有 MPS3 LCD，init() 回傳 false，main 會改為不顯示繼續執行；
+ * 畫面結果請看 VSIVideoOutput 輸出的 raw 檔案。
+ */
+
+#include "lcd_display.h"
+
+LCDDisplay::LCDDisplay()
+    : lcd_buffer_(nullptr), initialized_(false) {
+}
+
+LCDDisplay::~LCDDisplay() {
+}
+
+bool LCDDisplay::init() {
+    return false;
+}
+
+void LCDDisplay::displayFrame(const uint8_t* frame, int width, int height) {
+}
+
+void LCDDisplay::clear() {
+}
@@ -0,0 +1,25 @@
+/*
+ * host_platform.cpp - Host (x86 Linux) 平台替代
+ *
+ * 提供 FVP 上由 CMSIS system / DWT 提供的符號，讓 main 與各模組的
+ * cycle 計時換算 (cycles / SystemCoreClock) 在 host 上維持相同語意。
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+// 以 1 GHz 的虛擬時脈表示 nanoseconds，cycles / (SystemCoreClock / 1000) 即為 ms
+#define HOST_VIRTUAL_CLOCK_HZ 1000000000u
+
+extern "C" {
+
+uint32_t SystemCoreClock = HOST_VIRTUAL_CLOCK_HZ;
+
+uint32_t get_cycle_count() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // 32-bit 溢位 (~4.3 s) 與 DWT_CYCCNT 相同，呼叫端以無號差值計算
+    return (uint32_t)((uint64_t)ts.tv_sec * HOST_VIRTUAL_CLOCK_HZ + (uint64_t)ts.tv_nsec);
+}
+
+}
@@ -0,0 +1,143 @@
+/*
+ * host_video.cpp - Host build 的 VSIVideoController / VSIVideoOutput
+ *
+ * 以 raw RGB888 檔案取代 VSI 視訊串流，一幀為
+ * VSI_VIDEO_WIDTH x VSI_VIDEO_HEIGHT x 3 bytes，可用 ffmpeg 產生:
+ *   ffmpeg -i input.mp4 -vf scale=640:480 -f rawvideo -pix_fmt rgb24 input.rgb
+ * 輸出幀依序附加到 HOST_VIDEO_OUTPUT_FILE (同格式)。
+ */
+
+#include "vsi_video.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef HOST_VIDEO_OUTPUT_FILE
+#define HOST_VIDEO_OUTPUT_FILE "host_output.rgb"
+#endif
+
+#define HOST_FRAME_BYTES (VSI_VIDEO_WIDTH * VSI_VIDEO_HEIGHT * VSI_VIDEO_CHANNELS)
+
+static FILE* output_file = nullptr;
+
+VSIVideoController::VSIVideoController(const char* video_path)
+    : video_path_(video_path)
+    , frame_count_(0)
+    , total_frames_(0)
+    , frame_buffer_(nullptr)
+    , initialized_(false)
+    , vsi_handle_(nullptr)
+{
+}
+
+VSIVideoController::~VSIVideoController() {
+    if (vsi_handle_) {
+        fclose((FILE*)vsi_handle_);
+        vsi_handle_ = nullptr;
+    }
+}
+
+bool VSIVideoController::init() {
+    printf("[Video] Opening raw RGB888 input: %s\n", video_path_);
+    
+    FILE* f = fopen(video_path_, "rb");
+    if (!f) {
+        printf("[Video] Failed to open %s\n", video_path_);
+        return false;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    if (size < HOST_FRAME_BYTES) {
+        printf("[Video] %s is smaller than one %dx%d RGB888 frame\n",
+               video_path_, VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT);
+        fclose(f);
+        return false;
+    }
+    if (size % HOST_FRAME_BYTES != 0) {
+        printf("[Video] Warning: trailing %ld bytes ignored\n", size % HOST_FRAME_BYTES);
+    }
+    
+    vsi_handle_ = f;
+    total_frames_ = (int)(size / HOST_FRAME_BYTES);
+    frame_count_ = 0;
+    initialized_ = true;
+    
+    printf("[Video] Video initialized: %dx%d, %d frames\n",
+           VSI_VIDEO_WIDTH, VSI_VIDEO_HEIGHT, total_frames_);
+    return true;
+}
+
+bool VSIVideoController::getNextFrame(uint8_t* frame_buffer) {
+    if (!initialized_) {
+        printf("[Video] Video not initialized\n");
+        return false;
+    }
+    
+    frame_buffer_ = frame_buffer;
+    if (!readFrameFromFile()) {
+        return false;
+    }
+    
+    frame_count_++;
+    
+    if (frame_count_ % 30 == 0) {
+        printf("[Video] Processed frame %d\n", frame_count_);
+    }
+    
+    return true;
+}
+
+bool VSIVideoController::readFrameFromFile() {
+    FILE* f = (FILE*)vsi_handle_;
+    return fread(frame_buffer_, 1, HOST_FRAME_BYTES, f) == HOST_FRAME_BYTES;
+}
+
+void VSIVideoController::reset() {
+    if (vsi_handle_) {
+        fseek((FILE*)vsi_handle_, 0, SEEK_SET);
+    }
+    frame_count_ = 0;
+}
+
+bool VSIVideoController::hasMoreFrames() const {
+    return initialized_ && frame_count_ < total_frames_;
+}
+
+// ==========================================
+// VSIVideoOutput Implementation
+// ==========================================
+
+VSIVideoOutput::VSIVideoOutput() : initialized_(false), output_buffer_(nullptr) {}
+
+VSIVideoOutput::~VSIVideoOutput() {
+    if (output_file) {
+        fclose(output_file);
+        output_file = nullptr;
+    }
+}
+
+bool VSIVideoOutput::init() {
+    printf("[Video Out] Writing raw RGB888 output to %s\n", HOST_VIDEO_OUTPUT_FILE);
+    
+    output_file = fopen(HOST_VIDEO_OUTPUT_FILE, "wb");
+    if (!output_file) {
+        printf("[Video Out] Failed to open %s\n", HOST_VIDEO_OUTPUT_FILE);
+        return false;
+    }
+    
+    initialized_ = true;
+    return true;
+}
+
+bool VSIVideoOutput::sendFrame(const uint8_t* frame_buffer) {
+    if (!initialized_) return false;
+    
+    if (fwrite(frame_buffer, 1, HOST_FRAME_BYTES, output_file) != HOST_FRAME_BYTES) {
+        printf("[Video Out] Failed to write %s\n", HOST_VIDEO_OUTPUT_FILE);
+        return false;
+    }
+    return true;
+}
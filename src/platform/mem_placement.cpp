@@ -0,0 +1,69 @@
+#include "mem_placement.h"
+#include <stdio.h>
+
+struct PlacedBuffer {
+    const char* name;
+    const void* addr;
+    size_t size;
+};
+
+enum MemRegion {
+    MEM_ITCM = 0,
+    MEM_DTCM,
+    MEM_SRAM,
+    MEM_DDR,
+    MEM_OTHER,
+    MEM_NUM_REGIONS
+};
+
+static const char* const kRegionNames[MEM_NUM_REGIONS] = {
+    "ITCM", "DTCM", "SRAM", "DDR", "other"
+};
+
+static PlacedBuffer placed[MEM_PLACEMENT_MAX_BUFFERS];
+static int num_placed = 0;
+
+static MemRegion classify(const void* addr) {
+#if defined(HOST_BUILD)
+    (void)addr;
+    return MEM_OTHER;
+#else
+    // bit 28 為 Secure alias，兩者指向同一塊記憶體
+    uint32_t a = (uint32_t)(uintptr_t)addr & ~0x10000000u;
+    if (a < 0x00080000u) return MEM_ITCM;
+    if (a >= 0x20000000u && a < 0x20000000u + MEM_DTCM_SIZE) return MEM_DTCM;
+    if (a >= 0x21000000u && a < 0x21000000u + MEM_SRAM_SIZE) return MEM_SRAM;
+    if (a >= 0x60000000u && a < 0x70000000u) return MEM_DDR;
+    return MEM_OTHER;
+#endif
+}
+
+void MemPlacement::record(const char* name, const void* addr, size_t size) {
+    if (num_placed >= MEM_PLACEMENT_MAX_BUFFERS) {
+        return;
+    }
+    placed[num_placed].name = name;
+    placed[num_placed].addr = addr;
+    placed[num_placed].size = size;
+    num_placed++;
+}
+
+void MemPlacement::printReport() {
+    size_t totals[MEM_NUM_REGIONS] = {};
+    
+    printf("\n[Mem] Buffer placement:\n");
+    for (int i = 0; i < num_placed; i++) {
+        MemRegion r = classify(placed[i].addr);
+        totals[r] += placed[i].size;
+        printf("  %-24s %-5s %p %8u bytes\n", placed[i].name, kRegionNames[r],
+               placed[i].addr, (unsigned)placed[i].size);
+    }
+    
+    printf("  Total:");
+    for (int r = 0; r < MEM_NUM_REGIONS; r++) {
+        if (totals[r] > 0) {
+            printf(" %s %u KB", kRegionNames[r], (unsigned)((totals[r] + 1023) / 1024));
+        }
+    }
+    printf("\n");
+}
@@ -0,0 +1,71 @@
+/*
+ * mem_placement.h - 熱點緩衝區的記憶體區域配置
+ *
+ * 各群組緩衝區可放在 DDR (預設)、SRAM 或 DTCM，由 CMake 的
+ * MEM_PLACE_<GROUP> 選擇；SRAM/DTCM 需搭配 MEM_PLACEMENT=ON
+ * 使用 src/platform/gcc_corstone300.ld.in 產生的 linker script。
+ *
+ *   MEM_PLACE_TENSOR_ARENA : tensor arena (含 Ethos-U scratch/activation，不可放 DTCM: NPU 無法存取)
+ *   MEM_PLACE_GALLERY      : gallery embeddings 與相似度/cost 矩陣
+ *   MEM_PLACE_LUTS         : anchor 表、DFL exp LUT、ReID 輸入 LUT、投影矩陣
+ */
+
+#ifndef MEM_PLACEMENT_H
+#define MEM_PLACEMENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 可寫緩衝區 (SRAM/DTCM 於啟動時清零)
+#define MEM_REGION_DDR_ATTR  __attribute__((section(".ddr_data"), aligned(16)))
+#define MEM_REGION_SRAM_ATTR __attribute__((section(".sram_bss"), aligned(16)))
+#define MEM_REGION_DTCM_ATTR __attribute__((section(".dtcm_bss"), aligned(16)))
+
+// 唯讀表 (SRAM/DTCM 於啟動時從 flash 複製；DDR 設定下留在 .rodata)
+#define MEM_REGION_DDR_RO_ATTR
+#define MEM_REGION_SRAM_RO_ATTR __attribute__((section(".sram_rodata"), aligned(16)))
+#define MEM_REGION_DTCM_RO_ATTR __attribute__((section(".dtcm_rodata"), aligned(16)))
+
+#ifndef MEM_PLACE_TENSOR_ARENA
+#define MEM_PLACE_TENSOR_ARENA MEM_REGION_DDR
+#endif
+#ifndef MEM_PLACE_GALLERY
+#define MEM_PLACE_GALLERY MEM_REGION_DDR
+#endif
+#ifndef MEM_PLACE_LUTS
+#define MEM_PLACE_LUTS MEM_REGION_DDR
+#endif
+
+// MEM_PLACE(MEM_PLACE_GALLERY) -> MEM_REGION_xxx_ATTR
+#define MEM_PLACE(group) MEM_PLACE_I(group)
+#define MEM_PLACE_I(region) region##_ATTR
+#define MEM_PLACE_RO(group) MEM_PLACE_RO_I(group)
+#define MEM_PLACE_RO_I(region) region##_RO_ATTR
+
+// 區域名稱 (統計輸出用): MEM_PLACE_NAME(MEM_PLACE_TENSOR_ARENA) -> "DDR"
+#define MEM_REGION_DDR_NAME  "DDR"
+#define MEM_REGION_SRAM_NAME "SRAM"
+#define MEM_REGION_DTCM_NAME "DTCM"
+#define MEM_PLACE_NAME(group) MEM_PLACE_NAME_I(group)
+#define MEM_PLACE_NAME_I(region) region##_NAME
+
+// Corstone-300 記憶體配置 (Non-secure alias，大小需與 linker script 一致)
+#ifndef MEM_DTCM_SIZE
+#define MEM_DTCM_SIZE (512 * 1024)
+#endif
+#ifndef MEM_SRAM_SIZE
+#define MEM_SRAM_SIZE (2048 * 1024)
+#endif
+
+#define MEM_PLACEMENT_MAX_BUFFERS 24
+
+class MemPlacement {
+public:
+    // 登記一個緩衝區 (初始化時呼叫)，依位址判斷所在區域
+    static void record(const char* name, const void* addr, size_t size);
+    
+    // 輸出各緩衝區所在區域與各區域合計
+    static void printReport();
+};
+
+#endif // MEM_PLACEMENT_H
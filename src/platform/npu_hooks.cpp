@@ -0,0 +1,114 @@
+/*
+ * npu_hooks.cpp - Ethos-U driver weak 函式覆寫
+ *
+ * 對應 ethos_u_core_driver (ethosu_driver.c) 中的 bare-metal semaphore
+ * 實作，差別在於 take() 在需要等待時會先執行已登記的 CPU 工作，
+ * 並以靜態 pool 取代 malloc。
+ * Host build 沒有 Ethos-U driver，只保留 idle task API 供 NPU stand-in 使用。
+ */
+
+#include "npu_hooks.h"
+#include <stddef.h>
+#if !defined(HOST_BUILD)
+#include "CMSIS_5/Device/ARM/ARMCM55/Include/ARMCM55.h"
+#endif
+
+extern "C" uint32_t get_cycle_count();
+
+static NpuIdleTask pending_task = nullptr;
+static void* pending_ctx = nullptr;
+static bool task_ran = false;
+static uint32_t idle_task_runs = 0;
+static uint32_t idle_task_cycles = 0;
+
+void npu_set_idle_task(NpuIdleTask task, void* ctx) {
+    pending_task = task;
+    pending_ctx = ctx;
+    task_ran = false;
+}
+
+bool npu_clear_idle_task() {
+    pending_task = nullptr;
+    pending_ctx = nullptr;
+    return task_ran;
+}
+
+uint32_t npu_idle_task_runs() {
+    return idle_task_runs;
+}
+
+uint32_t npu_idle_task_cycles() {
+    return idle_task_cycles;
+}
+
+void npu_run_idle_task() {
+    if (pending_task == nullptr) return;
+    
+    NpuIdleTask task = pending_task;
+    void* ctx = pending_ctx;
+    pending_task = nullptr;
+    pending_ctx = nullptr;
+    
+    uint32_t start = get_cycle_count();
+    task(ctx);
+    idle_task_cycles += get_cycle_count() - start;
+    task_ran = true;
+    idle_task_runs++;
+}
+
+#if !defined(HOST_BUILD)
+
+#define NPU_MAX_SEMAPHORES 4
+
+struct NpuSemaphore {
+    volatile uint32_t count;
+    bool in_use;
+};
+
+static NpuSemaphore semaphore_pool[NPU_MAX_SEMAPHORES];
+
+extern "C" {
+
+void* ethosu_semaphore_create(void) {
+    for (int i = 0; i < NPU_MAX_SEMAPHORES; i++) {
+        if (!semaphore_pool[i].in_use) {
+            semaphore_pool[i].in_use = true;
+            semaphore_pool[i].count = 0;
+            return &semaphore_pool[i];
+        }
+    }
+    return NULL;
+}
+
+void ethosu_semaphore_destroy(void* sem) {
+    ((NpuSemaphore*)sem)->in_use = false;
+}
+
+int ethosu_semaphore_take(void* sem, uint64_t timeout) {
+    (void)timeout;
+    NpuSemaphore* s = (NpuSemaphore*)sem;
+    
+    // NPU 尚未完成時，先在 CPU 上執行登記的工作
+    if (s->count == 0) {
+        npu_run_idle_task();
+    }
+    
+    while (s->count == 0) {
+        __WFE();
+    }
+    
+    __disable_irq();
+    s->count--;
+    __enable_irq();
+    return 0;
+}
+
+int ethosu_semaphore_give(void* sem) {
+    ((NpuSemaphore*)sem)->count++;
+    __SEV();
+    return 0;
+}
+
+}
+
+#endif // !HOST_BUILD
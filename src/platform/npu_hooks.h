@@ -0,0 +1,33 @@
+/*
+ * npu_hooks.h - Ethos-U driver hook 覆寫
+ *
+ * TFLM 的 Invoke() 會在 Ethos-U driver 內阻塞等待 NPU 完成中斷。
+ * 這裡覆寫 driver 的 weak semaphore 函式，讓呼叫端可登記一個
+ * 「NPU 忙碌時在 CPU 上執行」的工作，以重疊 CPU 與 NPU 的時間。
+ */
+
+#ifndef NPU_HOOKS_H
+#define NPU_HOOKS_H
+
+#include <stdint.h>
+
+typedef void (*NpuIdleTask)(void* ctx);
+
+// 登記一次性工作: 下一次等待 NPU 時執行 (執行後自動清除)
+// 只有一個位置，尚未執行的工作會被新登記的工作取代
+void npu_set_idle_task(NpuIdleTask task, void* ctx);
+
+// 清除尚未執行的工作，回傳「最後一次登記的工作」是否已執行過
+// (中間有其他模組登記工作時，呼叫端需自行記錄完成狀態)
+bool npu_clear_idle_task();
+
+// 累計在 NPU 等待期間執行 CPU 工作的次數
+uint32_t npu_idle_task_runs();
+
+// 執行尚未執行的工作 (driver 等待 NPU 時呼叫；host stand-in 在「推論」前呼叫)
+void npu_run_idle_task();
+
+// 累計 idle task 佔用的 CPU cycles (推論計時可扣除此部分)
+uint32_t npu_idle_task_cycles();
+
+#endif // NPU_HOOKS_H
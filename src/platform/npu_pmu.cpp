@@ -0,0 +1,83 @@
+/*
+ * npu_pmu.cpp - Ethos-U PMU 計數擷取實作
+ *
+ * Ethos-U55 有 4 個事件計數器加上 cycle counter:
+ *   0: NPU_ACTIVE   1: AXI0 讀取   2: AXI0 寫入   3: AXI1 讀取
+ * AXI 埠依用途而非實體記憶體區分: AXI0 存取 tensor arena (activation /
+ * scratch，所在區域由 MEM_PLACE_TENSOR_ARENA 決定)，AXI1 讀取模型權重。
+ * 每次推論開始時重新設定 (NPU soft reset 會清除 PMU 設定)。
+ */
+
+#include "npu_pmu.h"
+#include "mem_placement.h"
+#include <stdio.h>
+#include <string.h>
+
+static NpuPmuCounters pending_counters;
+
+#if NPU_PMU_CAPTURE && !defined(HOST_BUILD)
+#include <ethosu_driver.h>
+#include <pmu_ethosu.h>
+
+#define NPU_PMU_COUNTER_MASK (ETHOSU_PMU_CNT1_Msk | ETHOSU_PMU_CNT2_Msk | \
+                              ETHOSU_PMU_CNT3_Msk | ETHOSU_PMU_CNT4_Msk | \
+                              ETHOSU_PMU_CCNT_Msk)
+
+extern "C" {
+
+void ethosu_inference_begin(struct ethosu_driver* drv, void* user_arg) {
+    ETHOSU_PMU_Enable(drv);
+    ETHOSU_PMU_Set_EVTYPER(drv, 0, ETHOSU_PMU_NPU_ACTIVE);
+    ETHOSU_PMU_Set_EVTYPER(drv, 1, ETHOSU_PMU_AXI0_RD_DATA_BEAT_RECEIVED);
+    ETHOSU_PMU_Set_EVTYPER(drv, 2, ETHOSU_PMU_AXI0_WR_DATA_BEAT_WRITTEN);
+    ETHOSU_PMU_Set_EVTYPER(drv, 3, ETHOSU_PMU_AXI1_RD_DATA_BEAT_RECEIVED);
+    ETHOSU_PMU_CYCCNT_Reset(drv);
+    ETHOSU_PMU_EVCNTR_ALL_Reset(drv);
+    ETHOSU_PMU_CNTR_Enable(drv, NPU_PMU_COUNTER_MASK);
+}
+
+void ethosu_inference_end(struct ethosu_driver* drv, void* user_arg) {
+    ETHOSU_PMU_CNTR_Disable(drv, NPU_PMU_COUNTER_MASK);
+    
+    pending_counters.cycles += ETHOSU_PMU_Get_CCNTR(drv);
+    pending_counters.active += ETHOSU_PMU_Get_EVCNTR(drv, 0);
+    pending_counters.axi0_read += ETHOSU_PMU_Get_EVCNTR(drv, 1);
+    pending_counters.axi0_write += ETHOSU_PMU_Get_EVCNTR(drv, 2);
+    pending_counters.axi1_read += ETHOSU_PMU_Get_EVCNTR(drv, 3);
+    pending_counters.inferences++;
+    
+    ETHOSU_PMU_Disable(drv);
+}
+
+}
+#endif
+
+void npu_pmu_collect(NpuPmuCounters* acc) {
+    acc->cycles += pending_counters.cycles;
+    acc->active += pending_counters.active;
+    acc->axi0_read += pending_counters.axi0_read;
+    acc->axi0_write += pending_counters.axi0_write;
+    acc->axi1_read += pending_counters.axi1_read;
+    acc->inferences += pending_counters.inferences;
+    memset(&pending_counters, 0, sizeof(pending_counters));
+}
+
+void npu_pmu_print(const NpuPmuCounters& c, int invokes, float cpu_ms) {
+    if (c.inferences == 0 || invokes <= 0 || c.cycles == 0) return;
+    
+    float cycles = (float)c.cycles / invokes;
+    float active = (float)c.active / invokes;
+    float rd0_kb = (float)c.axi0_read * NPU_PMU_AXI_BEAT_BYTES / 1024.0f / invokes;
+    float wr0_kb = (float)c.axi0_write * NPU_PMU_AXI_BEAT_BYTES / 1024.0f / invokes;
+    float rd1_kb = (float)c.axi1_read * NPU_PMU_AXI_BEAT_BYTES / 1024.0f / invokes;
+    uint64_t beats = c.axi0_read + c.axi0_write + c.axi1_read;
+    
+    printf("  NPU PMU (per Invoke, CPU %.2f ms):\n", cpu_ms);
+    printf("    NPU cycles: %.0f (active %.0f = %.1f%%, idle %.0f)\n",
+           cycles, active, 100.0f * active / cycles, cycles - active);
+    printf("    AXI0 (arena/scratch, %s) read/write: %.1f / %.1f KB\n",
+           MEM_PLACE_NAME(MEM_PLACE_TENSOR_ARENA), rd0_kb, wr0_kb);
+    printf("    AXI1 (model weights) read: %.1f KB\n", rd1_kb);
+    printf("    Bandwidth: %.2f bytes/active cycle\n",
+           c.active > 0 ? (float)beats * NPU_PMU_AXI_BEAT_BYTES / c.active : 0.0f);
+}
@@ -0,0 +1,37 @@
+/*
+ * npu_pmu.h - Ethos-U PMU 計數擷取
+ *
+ * 覆寫 driver 的 weak ethosu_inference_begin/end，在每次 NPU 推論前後
+ * 設定並讀取 PMU 計數器。呼叫端在 Invoke() 後以 npu_pmu_collect()
+ * 取走累計值，歸屬到對應的模型。
+ */
+
+#ifndef NPU_PMU_H
+#define NPU_PMU_H
+
+#include <stdint.h>
+
+// 預設關閉: PMU 設定/讀取會增加每次推論的 driver 開銷
+#ifndef NPU_PMU_CAPTURE
+#define NPU_PMU_CAPTURE 0
+#endif
+
+// Ethos-U55 AXI 資料寬度 64-bit
+#define NPU_PMU_AXI_BEAT_BYTES 8
+
+struct NpuPmuCounters {
+    uint64_t cycles;        // NPU cycle counter (CCNT)
+    uint64_t active;        // NPU_ACTIVE cycles (idle = cycles - active)
+    uint64_t axi0_read;     // AXI0 (tensor arena / scratch) 讀取 beats
+    uint64_t axi0_write;    // AXI0 (tensor arena / scratch) 寫入 beats
+    uint64_t axi1_read;     // AXI1 (模型權重) 讀取 beats
+    uint32_t inferences;    // ethos-u op 執行次數
+};
+
+// 將上次呼叫後累計的計數加到 *acc 並清除 (Invoke 後呼叫)
+void npu_pmu_collect(NpuPmuCounters* acc);
+
+// 輸出模型的 PMU 統計 (invokes 次 Invoke，CPU 量測平均 cpu_ms)
+void npu_pmu_print(const NpuPmuCounters& c, int invokes, float cpu_ms);
+
+#endif // NPU_PMU_H
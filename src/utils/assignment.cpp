@@ -0,0 +1,93 @@
+#include "assignment.h"
+#include <stdio.h>
+#include <float.h>
+
+// 工作區 (1-indexed，索引 0 為虛擬起點)
+static float pot_short[ASSIGNMENT_MAX_SHORT + 1];
+static float pot_long[ASSIGNMENT_MAX_DIM + 1];
+static float min_slack[ASSIGNMENT_MAX_DIM + 1];
+static int16_t match_of[ASSIGNMENT_MAX_DIM + 1];   // 長邊 j 指派到的短邊索引
+static int16_t prev_of[ASSIGNMENT_MAX_DIM + 1];
+static bool visited[ASSIGNMENT_MAX_DIM + 1];
+
+float Assignment::solveMin(const float* cost, int rows, int cols, int* row_to_col) {
+    for (int r = 0; r < rows; r++) row_to_col[r] = -1;
+    if (rows <= 0 || cols <= 0) return 0.0f;
+    
+    // 演算法要求短邊 n <= 長邊 m；列數較多時以轉置方式存取
+    const bool transposed = rows > cols;
+    const int n = transposed ? cols : rows;
+    const int m = transposed ? rows : cols;
+    if (n > ASSIGNMENT_MAX_SHORT || m > ASSIGNMENT_MAX_DIM) {
+        printf("[Assign] Matrix %dx%d exceeds limit\n", rows, cols);
+        return 0.0f;
+    }
+    
+    #define COST(i, j) (transposed ? cost[(j) * cols + (i)] : cost[(i) * cols + (j)])
+    
+    for (int i = 0; i <= n; i++) pot_short[i] = 0.0f;
+    for (int j = 0; j <= m; j++) {
+        pot_long[j] = 0.0f;
+        match_of[j] = 0;
+    }
+    
+    // 逐一加入短邊的每個點，沿最短增廣路徑更新指派
+    for (int i = 1; i <= n; i++) {
+        match_of[0] = (int16_t)i;
+        int j0 = 0;
+        for (int j = 0; j <= m; j++) {
+            min_slack[j] = FLT_MAX;
+            visited[j] = false;
+        }
+        
+        do {
+            visited[j0] = true;
+            int i0 = match_of[j0];
+            float delta = FLT_MAX;
+            int j1 = 0;
+            for (int j = 1; j <= m; j++) {
+                if (visited[j]) continue;
+                float slack = COST(i0 - 1, j - 1) - pot_short[i0] - pot_long[j];
+                if (slack < min_slack[j]) {
+                    min_slack[j] = slack;
+                    prev_of[j] = (int16_t)j0;
+                }
+                if (min_slack[j] < delta) {
+                    delta = min_slack[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (visited[j]) {
+                    pot_short[match_of[j]] += delta;
+                    pot_long[j] -= delta;
+                } else {
+                    min_slack[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (match_of[j0] != 0);
+        
+        // 沿路徑回溯翻轉指派
+        do {
+            int j1 = prev_of[j0];
+            match_of[j0] = match_of[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    
+    float total = 0.0f;
+    for (int j = 1; j <= m; j++) {
+        if (match_of[j] == 0) continue;
+        int i = match_of[j] - 1;
+        total += COST(i, j - 1);
+        if (transposed) {
+            row_to_col[j - 1] = i;
+        } else {
+            row_to_col[i] = j - 1;
+        }
+    }
+    
+    #undef COST
+    return total;
+}
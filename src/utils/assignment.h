@@ -0,0 +1,19 @@
+#ifndef ASSIGNMENT_H
+#define ASSIGNMENT_H
+
+#include <stdint.h>
+
+// 矩陣較長邊 / 較短邊的上限 (工作區為靜態配置)
+#define ASSIGNMENT_MAX_DIM   320
+#define ASSIGNMENT_MAX_SHORT 64
+
+// 一對一指派 (匈牙利演算法，O(n^2 m))
+class Assignment {
+public:
+    // cost 為 rows x cols (row-major)，求總成本最小的一對一指派
+    // row_to_col[r] 為第 r 列指派到的欄 (欄數少於列數時，未指派的列為 -1)
+    // 回傳總成本；尺寸超過上限時回傳 0 且所有列皆為 -1
+    static float solveMin(const float* cost, int rows, int cols, int* row_to_col);
+};
+
+#endif // ASSIGNMENT_H
@@ -388,7 +388,7 @@ void DrawUtils::drawConfidence(uint8_t* image, int width, int height,
 
 void DrawUtils::drawSkeleton(uint8_t* image, int width, int height,
                              const HumanPose keypoints[NUM_KEYPOINTS],
-                             float scale_x, float scale_y,
+                             const ImageTransform& transform,
                              const Color& color, float threshold) {
     // 繪製骨架連接
     for (int i = 0; i < NUM_SKELETON_CONNECTIONS; i++) {
@@ -396,10 +396,10 @@ void DrawUtils::drawSkeleton(uint8_t* image, int width, int height,
         int p2 = SKELETON_CONNECTIONS[i][1];
         
         if (keypoints[p1].score > threshold && keypoints[p2].score > threshold) {
-            int x1 = (int)((float)keypoints[p1].x * scale_x);
-            int y1 = (int)((float)keypoints[p1].y * scale_y);
-            int x2 = (int)((float)keypoints[p2].x * scale_x);
-            int y2 = (int)((float)keypoints[p2].y * scale_y);
+            int x1 = (int)transform.toSourceX((float)keypoints[p1].x);
+            int y1 = (int)transform.toSourceY((float)keypoints[p1].y);
+            int x2 = (int)transform.toSourceX((float)keypoints[p2].x);
+            int y2 = (int)transform.toSourceY((float)keypoints[p2].y);
             
             drawLine(image, width, height, x1, y1, x2, y2, color, 2);
         }
@@ -408,8 +408,8 @@ void DrawUtils::drawSkeleton(uint8_t* image, int width, int height,
     // 繪製關鍵點
     for (int i = 0; i < NUM_KEYPOINTS; i++) {
         if (keypoints[i].score > threshold) {
-            int x = (int)((float)keypoints[i].x * scale_x);
-            int y = (int)((float)keypoints[i].y * scale_y);
+            int x = (int)transform.toSourceX((float)keypoints[i].x);
+            int y = (int)transform.toSourceY((float)keypoints[i].y);
             drawCircle(image, width, height, x, y, 3, color, true);
         }
     }
@@ -418,14 +418,14 @@ void DrawUtils::drawSkeleton(uint8_t* image, int width, int height,
 void DrawUtils::drawDetection(uint8_t* image, int width, int height,
                               const PersonDetection& detection,
                               int person_id,
-                              float scale_x, float scale_y) {
+                              const ImageTransform& transform) {
     Color color = getColorForPerson(person_id);
     
     // 計算縮放後的 bounding box
-    int x1 = (int)(detection.bbox.x * scale_x);
-    int y1 = (int)(detection.bbox.y * scale_y);
-    int x2 = (int)((detection.bbox.x + detection.bbox.w) * scale_x);
-    int y2 = (int)((detection.bbox.y + detection.bbox.h) * scale_y);
+    int x1 = (int)transform.toSourceX(detection.bbox.x);
+    int y1 = (int)transform.toSourceY(detection.bbox.y);
+    int x2 = (int)transform.toSourceX(detection.bbox.x + detection.bbox.w);
+    int y2 = (int)transform.toSourceY(detection.bbox.y + detection.bbox.h);
     
     // 繪製 bounding box
     drawRect(image, width, height, x1, y1, x2, y2, color, 3);
@@ -448,7 +448,7 @@ void DrawUtils::drawDetection(uint8_t* image, int width, int height,
     drawPersonID(image, width, height, x1 + 2, label_y1 + 2, person_id, color, 2);
     
     // 繪製骨架
-    drawSkeleton(image, width, height, detection.keypoints, scale_x, scale_y, color, 0.3f);
+    drawSkeleton(image, width, height, detection.keypoints, transform, color, 0.3f);
 }
 
 Color DrawUtils::getColorForPerson(int person_id) {
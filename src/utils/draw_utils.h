@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include "yolo_pose.h"  // 引入 PersonDetection, HumanPose 等定義
+#include "image_utils.h"  // 引入 ImageTransform
 
 // 顏色定義 (RGB888)
 struct Color {
@@ -110,17 +111,17 @@ public:
                                int x, int y, float confidence,
                                const Color& color, int scale = 1);
     
-    // 繪製骨架
+    // 繪製骨架 (transform: 模型輸入座標 -> 影像座標)
     static void drawSkeleton(uint8_t* image, int width, int height,
                              const HumanPose keypoints[NUM_KEYPOINTS],
-                             float scale_x, float scale_y,
+                             const ImageTransform& transform,
                              const Color& color, float threshold = 0.3f);
     
     // 繪製完整的偵測結果 (bounding box + ID + skeleton)
     static void drawDetection(uint8_t* image, int width, int height,
                               const PersonDetection& detection,
                               int person_id,
-                              float scale_x, float scale_y);
+                              const ImageTransform& transform);
     
     // 根據 Person ID 獲取顏色
     static Color getColorForPerson(int person_id);
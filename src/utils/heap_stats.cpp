@@ -0,0 +1,53 @@
+#include "heap_stats.h"
+#include <stddef.h>
+#include <stdlib.h>
+
+static volatile uint32_t heap_alloc_count = 0;
+static volatile uint32_t heap_free_count = 0;
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t num, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    heap_alloc_count++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t num, size_t size) {
+    heap_alloc_count++;
+    return __real_calloc(num, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    heap_alloc_count++;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) {
+        heap_free_count++;
+    }
+    __real_free(ptr);
+}
+
+}
+
+uint32_t HeapStats::allocCount() {
+    return heap_alloc_count;
+}
+
+uint32_t HeapStats::freeCount() {
+    return heap_free_count;
+}
+
+bool HeapStats::verifyWrap() {
+    uint32_t before = heap_alloc_count;
+    // volatile 避免 malloc/free 成對被編譯器消除
+    void* volatile probe = malloc(16);
+    free(probe);
+    return heap_alloc_count != before;
+}
@@ -0,0 +1,22 @@
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include <stdint.h>
+
+// Heap 配置統計
+// 透過 linker 的 --wrap=malloc/calloc/realloc/free 攔截所有配置
+// (包含 operator new)，用來確認穩態下每幀沒有 heap 配置。
+class HeapStats {
+public:
+    // 累計配置次數 (malloc/calloc/realloc)
+    static uint32_t allocCount();
+    
+    // 累計釋放次數
+    static uint32_t freeCount();
+    
+    // 配置一次並確認計數有遞增。-flto 時 ld 的 --wrap 不一定會改寫
+    // 只存在於 LTO IR 內的參照，此時計數恆為 0，不能當作「沒有配置」
+    static bool verifyWrap();
+};
+
+#endif // HEAP_STATS_H
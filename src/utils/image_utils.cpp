@@ -1,8 +1,40 @@
 #include "image_utils.h"
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define IMAGE_UTILS_USE_MVE 1
+#endif
+
+// resizeToInt8 Helium 路徑支援的最大輸出寬度
+#define IMAGE_UTILS_MAX_DST_WIDTH 1024
+
+static inline int8_t clampToInt8(int32_t value) {
+    if (value < -128) return -128;
+    if (value > 127) return 127;
+    return (int8_t)value;
+}
+
+#if defined(IMAGE_UTILS_USE_MVE)
+// 每個輸出 byte 在來源列中的 offset (所有列共用)
+static uint16_t col_offsets[IMAGE_UTILS_MAX_DST_WIDTH * 3];
+
+static const uint16_t* buildColumnOffsets(int src_w, int dst_w) {
+    for (int x = 0; x < dst_w; x++) {
+        uint16_t base = (uint16_t)(((x * src_w) / dst_w) * 3);
+        col_offsets[x * 3 + 0] = base;
+        col_offsets[x * 3 + 1] = base + 1;
+        col_offsets[x * 3 + 2] = base + 2;
+    }
+    return col_offsets;
+}
+#endif
 
 // ARM cycle counter
+// Host build 由 src/platform/host/host_platform.cpp 提供
+#if !defined(HOST_BUILD)
 extern "C" uint32_t get_cycle_count() {
 #if defined(__aarch64__)
     uint32_t value;
@@ -16,6 +48,7 @@ extern "C" uint32_t get_cycle_count() {
     return *DWT_CYCCNT;
 #endif
 }
+#endif
 
 void ImageUtils::resize(const uint8_t* src, int src_w, int src_h,
                        uint8_t* dst, int dst_w, int dst_h) {
@@ -35,6 +68,165 @@ void ImageUtils::resize(const uint8_t* src, int src_w, int src_h,
     }
 }
 
+void ImageUtils::resizeToInt8Scalar(const uint8_t* src, int src_w, int src_h,
+                                    int8_t* dst, int dst_w, int dst_h, int32_t offset,
+                                    int dst_stride) {
+    if (dst_stride == 0) dst_stride = dst_w * 3;
+    
+    // 最近鄰插值，與 resize() 相同的取樣位置
+    for (int y = 0; y < dst_h; y++) {
+        const uint8_t* src_row = src + ((y * src_h) / dst_h) * src_w * 3;
+        int8_t* dst_row = dst + y * dst_stride;
+        
+        for (int x = 0; x < dst_w; x++) {
+            const uint8_t* p = src_row + ((x * src_w) / dst_w) * 3;
+            dst_row[x * 3 + 0] = clampToInt8((int32_t)p[0] + offset);
+            dst_row[x * 3 + 1] = clampToInt8((int32_t)p[1] + offset);
+            dst_row[x * 3 + 2] = clampToInt8((int32_t)p[2] + offset);
+        }
+    }
+}
+
+void ImageUtils::resizeToInt8(const uint8_t* src, int src_w, int src_h,
+                              int8_t* dst, int dst_w, int dst_h, int32_t offset,
+                              int dst_stride) {
+    if (dst_stride == 0) dst_stride = dst_w * 3;
+    
+#if defined(IMAGE_UTILS_USE_MVE)
+    // gather offset 為 16-bit，來源列需小於 64KB
+    if (dst_w > IMAGE_UTILS_MAX_DST_WIDTH || src_w * 3 > 0xFFFF) {
+        resizeToInt8Scalar(src, src_w, src_h, dst, dst_w, dst_h, offset, dst_stride);
+        return;
+    }
+    
+    const uint16_t* offsets = buildColumnOffsets(src_w, dst_w);
+    const int row_bytes = dst_w * 3;
+    
+    const int16x8_t v_min = vdupq_n_s16(-128);
+    const int16x8_t v_max = vdupq_n_s16(127);
+    
+    for (int y = 0; y < dst_h; y++) {
+        const uint8_t* src_row = src + ((y * src_h) / dst_h) * src_w * 3;
+        int8_t* dst_row = dst + y * dst_stride;
+        
+        // 每次處理 8 個 byte: gather 載入 -> 加 offset -> 飽和 -> 窄化儲存
+        for (int i = 0; i < row_bytes; i += 8) {
+            mve_pred16_t p = vctp16q(row_bytes - i);
+            uint16x8_t off = vld1q_z_u16(&offsets[i], p);
+            uint16x8_t pix = vldrbq_gather_offset_z_u16(src_row, off, p);
+            int16x8_t v = vaddq_n_s16(vreinterpretq_s16_u16(pix), (int16_t)offset);
+            v = vminq_s16(vmaxq_s16(v, v_min), v_max);
+            vstrbq_p_s16(&dst_row[i], v, p);
+        }
+    }
+#else
+    resizeToInt8Scalar(src, src_w, src_h, dst, dst_w, dst_h, offset, dst_stride);
+#endif
+}
+
+void ImageUtils::resizeWithLUTScalar(const ImageView& src, int8_t* dst, int dst_w, int dst_h,
+                                     const int8_t* lut) {
+    for (int y = 0; y < dst_h; y++) {
+        const uint8_t* src_row = src.pixel(0, (y * src.height) / dst_h);
+        int8_t* dst_row = dst + y * dst_w * 3;
+        
+        for (int x = 0; x < dst_w; x++) {
+            const uint8_t* p = src_row + ((x * src.width) / dst_w) * 3;
+            dst_row[x * 3 + 0] = lut[p[0]];
+            dst_row[x * 3 + 1] = lut[p[1]];
+            dst_row[x * 3 + 2] = lut[p[2]];
+        }
+    }
+}
+
+void ImageUtils::resizeWithLUT(const ImageView& src, int8_t* dst, int dst_w, int dst_h,
+                               const int8_t* lut) {
+#if defined(IMAGE_UTILS_USE_MVE)
+    if (dst_w > IMAGE_UTILS_MAX_DST_WIDTH || src.width * 3 > 0xFFFF) {
+        resizeWithLUTScalar(src, dst, dst_w, dst_h, lut);
+        return;
+    }
+    
+    const uint16_t* offsets = buildColumnOffsets(src.width, dst_w);
+    const int row_bytes = dst_w * 3;
+    
+    for (int y = 0; y < dst_h; y++) {
+        const uint8_t* src_row = src.pixel(0, (y * src.height) / dst_h);
+        int8_t* dst_row = dst + y * row_bytes;
+        
+        // 兩次 gather: 先取像素值，再以像素值為 offset 查表
+        for (int i = 0; i < row_bytes; i += 8) {
+            mve_pred16_t p = vctp16q(row_bytes - i);
+            uint16x8_t off = vld1q_z_u16(&offsets[i], p);
+            uint16x8_t pix = vldrbq_gather_offset_z_u16(src_row, off, p);
+            int16x8_t v = vldrbq_gather_offset_z_s16(lut, pix, p);
+            vstrbq_p_s16(&dst_row[i], v, p);
+        }
+    }
+#else
+    resizeWithLUTScalar(src, dst, dst_w, dst_h, lut);
+#endif
+}
+
+void ImageUtils::buildNormalizeLUT(float scale, int32_t zero_point, int8_t* lut) {
+    for (int v = 0; v < 256; v++) {
+        float normalized = (v / 255.0f - 0.5f) * 2.0f;
+        lut[v] = clampToInt8((int32_t)roundf(normalized / scale) + zero_point);
+    }
+}
+
+ImageTransform ImageUtils::letterboxToInt8(const uint8_t* src, int src_w, int src_h,
+                                           int8_t* dst, int dst_w, int dst_h,
+                                           int32_t offset, int8_t pad_value) {
+    // 等比縮放到可放入 dst 的最大尺寸，置中
+    int new_w = dst_w;
+    int new_h = (src_h * dst_w + src_w / 2) / src_w;
+    if (new_h > dst_h) {
+        new_h = dst_h;
+        new_w = (src_w * dst_h + src_h / 2) / src_h;
+    }
+    int pad_x = (dst_w - new_w) / 2;
+    int pad_y = (dst_h - new_h) / 2;
+    int row_bytes = dst_w * 3;
+    
+    // 只填充 padding 區域
+    if (pad_y > 0) {
+        memset(dst, pad_value, pad_y * row_bytes);
+    }
+    int bottom = pad_y + new_h;
+    if (bottom < dst_h) {
+        memset(dst + bottom * row_bytes, pad_value, (dst_h - bottom) * row_bytes);
+    }
+    if (new_w < dst_w) {
+        int right = pad_x + new_w;
+        for (int y = pad_y; y < bottom; y++) {
+            int8_t* row = dst + y * row_bytes;
+            memset(row, pad_value, pad_x * 3);
+            memset(row + right * 3, pad_value, (dst_w - right) * 3);
+        }
+    }
+    
+    // 內容區域
+    resizeToInt8(src, src_w, src_h, dst + pad_y * row_bytes + pad_x * 3,
+                 new_w, new_h, offset, row_bytes);
+    
+    ImageTransform transform;
+    transform.scale_x = (float)src_w / new_w;
+    transform.scale_y = (float)src_h / new_h;
+    transform.pad_x = (float)pad_x;
+    transform.pad_y = (float)pad_y;
+    return transform;
+}
+
+ImageTransform ImageUtils::stretchTransform(int src_w, int src_h, int dst_w, int dst_h) {
+    ImageTransform transform;
+    transform.scale_x = (float)src_w / dst_w;
+    transform.scale_y = (float)src_h / dst_h;
+    transform.pad_x = 0.0f;
+    transform.pad_y = 0.0f;
+    return transform;
+}
+
 void ImageUtils::crop(const uint8_t* src, int src_w, int src_h,
                      uint8_t* dst, int x, int y, int crop_w, int crop_h) {
     for (int row = 0; row < crop_h; row++) {
@@ -3,12 +3,71 @@
 
 #include <stdint.h>
 
+// 模型輸入座標 -> 原始影像座標的轉換 (由前處理產生，後處理/繪圖共用)
+struct ImageTransform {
+    float scale_x;   // 原始影像像素 / 模型輸入像素
+    float scale_y;
+    float pad_x;     // 內容區域在模型輸入中的起點 (letterbox padding)
+    float pad_y;
+    
+    float toSourceX(float x) const { return (x - pad_x) * scale_x; }
+    float toSourceY(float y) const { return (y - pad_y) * scale_y; }
+};
+
+// 影像中的矩形區域 (指向原始影像，不複製資料)
+struct ImageView {
+    const uint8_t* data;   // 完整影像起點 (RGB888)
+    int stride;            // 每列 bytes
+    int x, y;              // ROI 左上角
+    int width, height;     // ROI 尺寸
+    
+    const uint8_t* pixel(int col, int row) const {
+        return data + (y + row) * stride + (x + col) * 3;
+    }
+};
+
 class ImageUtils {
 public:
     // 圖像縮放
     static void resize(const uint8_t* src, int src_w, int src_h,
                       uint8_t* dst, int dst_w, int dst_h);
     
+    // 縮放並量化為 int8 (單一 pass): dst = clamp(src + offset, -128, 127)
+    // 於 Cortex-M55 使用 Helium (MVE) gather 路徑，其他平台使用純量版本
+    // dst_stride 為輸出每列 bytes (0 表示 dst_w * 3)
+    static void resizeToInt8(const uint8_t* src, int src_w, int src_h,
+                             int8_t* dst, int dst_w, int dst_h, int32_t offset,
+                             int dst_stride = 0);
+    
+    // resizeToInt8 的純量參考實作 (可於 host 上測試)
+    static void resizeToInt8Scalar(const uint8_t* src, int src_w, int src_h,
+                                   int8_t* dst, int dst_w, int dst_h, int32_t offset,
+                                   int dst_stride = 0);
+    
+    // 保持長寬比的 letterbox 縮放 + 量化，padding 以 pad_value 填充
+    // 回傳模型座標 -> 原始影像座標的轉換
+    static ImageTransform letterboxToInt8(const uint8_t* src, int src_w, int src_h,
+                                          int8_t* dst, int dst_w, int dst_h,
+                                          int32_t offset, int8_t pad_value);
+    
+    // 從 ROI 縮放並以 256 項查表轉換為 int8 (單一 pass): dst = lut[src]
+    // 於 Cortex-M55 使用 Helium gather 查表
+    static void resizeWithLUT(const ImageView& src, int8_t* dst, int dst_w, int dst_h,
+                              const int8_t* lut);
+    
+    // resizeWithLUT 的純量參考實作
+    static void resizeWithLUTScalar(const ImageView& src, int8_t* dst, int dst_w, int dst_h,
+                                    const int8_t* lut);
+    
+    // 建立 resizeWithLUT 的查表: 像素正規化到 [-1, 1] 後依輸入張量的
+    // scale / zero_point 量化並飽和到 int8，以 float 計算:
+    //   lut[v] = clamp((int32_t)roundf(((v / 255.0f - 0.5f) * 2.0f) / scale) + zero_point)
+    // roundf 在 .5 時遠離零
+    static void buildNormalizeLUT(float scale, int32_t zero_point, int8_t* lut);
+    
+    // 非等比縮放 (resize) 對應的轉換
+    static ImageTransform stretchTransform(int src_w, int src_h, int dst_w, int dst_h);
+    
     // 裁切 ROI
     static void crop(const uint8_t* src, int src_w, int src_h,
                     uint8_t* dst, int x, int y, int crop_w, int crop_h);
@@ -0,0 +1,132 @@
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+#if !defined(HOST_BUILD)
+#include "CMSIS_5/Device/ARM/ARMCM55/Include/ARMCM55.h"
+#endif
+
+extern "C" uint32_t get_cycle_count();
+extern "C" uint32_t SystemCoreClock;
+
+struct StageHistogram {
+    uint32_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint32_t buckets[PROFILER_HIST_BUCKETS];
+};
+
+static const char* const kStageNames[PROF_NUM_STAGES] = {
+    "frame", "capture", "yolo preprocess", "yolo invoke", "yolo decode", "yolo nms",
+    "track", "reid crop", "reid preprocess", "reid invoke", "reid (frame)",
+    "match", "draw", "lcd", "output"
+};
+
+static StageHistogram histograms[PROF_NUM_STAGES] __attribute__((section(".ddr_data"), aligned(16)));
+static uint32_t last_count = 0;
+static uint64_t high_bits = 0;
+
+void Profiler::init() {
+#if !defined(HOST_BUILD)
+    // DWT 需先開啟 trace 才會計數
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    memset(histograms, 0, sizeof(histograms));
+    last_count = get_cycle_count();
+    high_bits = 0;
+}
+
+uint64_t Profiler::now() {
+    uint32_t count = get_cycle_count();
+    if (count < last_count) {
+        high_bits += 1ULL << 32;
+    }
+    last_count = count;
+    return high_bits | count;
+}
+
+int Profiler::bucketOf(uint64_t cycles) {
+    if (cycles < PROFILER_HIST_SUB_BUCKETS) return (int)cycles;
+    
+    int log2 = 63 - __builtin_clzll(cycles);
+    if (log2 > PROFILER_HIST_MAX_LOG2) return PROFILER_HIST_BUCKETS - 1;
+    
+    // 最高位之後的 PROFILER_HIST_SUB_BITS 位元決定子區間
+    int sub = (int)(cycles >> (log2 - PROFILER_HIST_SUB_BITS)) & (PROFILER_HIST_SUB_BUCKETS - 1);
+    int bucket = (log2 - PROFILER_HIST_SUB_BITS + 1) * PROFILER_HIST_SUB_BUCKETS + sub;
+    return bucket < PROFILER_HIST_BUCKETS ? bucket : PROFILER_HIST_BUCKETS - 1;
+}
+
+uint64_t Profiler::bucketLowerBound(int bucket) {
+    if (bucket < PROFILER_HIST_SUB_BUCKETS) return (uint64_t)bucket;
+    
+    int log2 = bucket / PROFILER_HIST_SUB_BUCKETS + PROFILER_HIST_SUB_BITS - 1;
+    int sub = bucket % PROFILER_HIST_SUB_BUCKETS;
+    return (uint64_t)(PROFILER_HIST_SUB_BUCKETS + sub) << (log2 - PROFILER_HIST_SUB_BITS);
+}
+
+void Profiler::record(ProfileStage stage, uint64_t cycles) {
+    StageHistogram& h = histograms[stage];
+    if (h.count == 0 || cycles < h.min) h.min = cycles;
+    if (cycles > h.max) h.max = cycles;
+    h.count++;
+    h.total += cycles;
+    h.buckets[bucketOf(cycles)]++;
+}
+
+uint32_t Profiler::count(ProfileStage stage) {
+    return histograms[stage].count;
+}
+
+uint64_t Profiler::percentile(ProfileStage stage, float pct) {
+    const StageHistogram& h = histograms[stage];
+    if (h.count == 0) return 0;
+    
+    // nearest-rank
+    uint32_t rank = (uint32_t)(pct / 100.0f * h.count + 0.999f);
+    if (rank < 1) rank = 1;
+    if (rank > h.count) rank = h.count;
+    
+    uint32_t seen = 0;
+    for (int b = 0; b < PROFILER_HIST_BUCKETS; b++) {
+        if (seen + h.buckets[b] < rank) {
+            seen += h.buckets[b];
+            continue;
+        }
+        
+        // 假設區間內均勻分佈，依排名內插，並限制在實際觀測到的範圍內
+        uint64_t lower = bucketLowerBound(b);
+        uint64_t upper = (b + 1 < PROFILER_HIST_BUCKETS) ? bucketLowerBound(b + 1) : h.max + 1;
+        float frac = (rank - seen - 0.5f) / h.buckets[b];
+        uint64_t value = lower + (uint64_t)((upper - lower) * frac);
+        if (value < h.min) value = h.min;
+        if (value > h.max) value = h.max;
+        return value;
+    }
+    return h.max;
+}
+
+void Profiler::printReport() {
+    const float cycles_per_ms = SystemCoreClock / 1000.0f;
+    
+    printf("[Profiler] Stage latency (ms, %lu cycles/ms):\n", (unsigned long)(SystemCoreClock / 1000));
+    printf("  %-16s %7s %8s %8s %8s %8s %8s %8s\n",
+           "stage", "count", "mean", "min", "p50", "p95", "p99", "max");
+    
+    for (int s = 0; s < PROF_NUM_STAGES; s++) {
+        const StageHistogram& h = histograms[s];
+        if (h.count == 0) continue;
+        
+        ProfileStage stage = (ProfileStage)s;
+        printf("  %-16s %7lu %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+               kStageNames[s], (unsigned long)h.count,
+               (float)h.total / h.count / cycles_per_ms,
+               h.min / cycles_per_ms,
+               percentile(stage, 50.0f) / cycles_per_ms,
+               percentile(stage, 95.0f) / cycles_per_ms,
+               percentile(stage, 99.0f) / cycles_per_ms,
+               h.max / cycles_per_ms);
+    }
+}
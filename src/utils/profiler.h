@@ -0,0 +1,85 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+// 各階段的 cycle 計時與延遲分佈 (p50/p95/p99)
+// 關閉時 PROFILE_SCOPE / PROFILE_RECORD 不產生任何程式碼
+#ifndef APP_PROFILING
+#define APP_PROFILING 1
+#endif
+
+// 直方圖: 以 2 為底的對數刻度，每個 2 倍區間再分 PROFILER_HIST_SUB_BUCKETS 格
+// (16 格時每格寬約 6%，區間內再依排名線性內插)，涵蓋到 2^40 cycles
+#define PROFILER_HIST_SUB_BITS    4
+#define PROFILER_HIST_SUB_BUCKETS (1 << PROFILER_HIST_SUB_BITS)
+#define PROFILER_HIST_MAX_LOG2    40
+#define PROFILER_HIST_BUCKETS     ((PROFILER_HIST_MAX_LOG2 - PROFILER_HIST_SUB_BITS + 1) * PROFILER_HIST_SUB_BUCKETS)
+
+// processFrame() 的各階段 (階段之間不需互斥，例如 PROF_REID 包含該幀所有 PROF_REID_INVOKE)
+enum ProfileStage {
+    PROF_FRAME = 0,         // 整幀 (擷取到輸出，管線模式含上一幀的完成階段)
+    PROF_CAPTURE,           // 讀取輸入幀
+    PROF_YOLO_PREPROCESS,   // resize / letterbox + int8 量化
+    PROF_YOLO_INVOKE,       // YOLO Invoke (扣除 NPU 等待期間執行的 CPU 工作)
+    PROF_YOLO_DECODE,       // 候選框解碼
+    PROF_YOLO_NMS,          // NMS
+    PROF_TRACK,             // IoU / Kalman 追蹤
+    PROF_REID_CROP,         // 計算 Re-ID 裁切區域
+    PROF_REID_PREPROCESS,   // 每個人物的 Re-ID 前處理
+    PROF_REID_INVOKE,       // 每個人物的 Re-ID Invoke (扣除 NPU 等待期間執行的 CPU 工作)
+    PROF_REID,              // 整幀的批次 Re-ID 特徵提取
+    PROF_MATCH,             // Gallery 匹配
+    PROF_DRAW,              // 繪製偵測結果
+    PROF_LCD,               // LCD 顯示
+    PROF_OUTPUT,            // 視訊輸出
+    PROF_NUM_STAGES
+};
+
+class Profiler {
+public:
+    // 啟用 DWT cycle counter (在任何計時之前呼叫一次)
+    static void init();
+    
+    // 64-bit cycle 計數: 以 32-bit 計數器擴展，兩次呼叫間隔需小於 2^32 cycles
+    // (每幀至少呼叫一次即可保證)
+    static uint64_t now();
+    
+    // 記錄一次樣本
+    static void record(ProfileStage stage, uint64_t cycles);
+    
+    // 查詢統計 (percentile 為 0~100)
+    static uint32_t count(ProfileStage stage);
+    static uint64_t percentile(ProfileStage stage, float pct);
+    
+    // 輸出所有階段的延遲分佈
+    static void printReport();
+    
+private:
+    static int bucketOf(uint64_t cycles);
+    static uint64_t bucketLowerBound(int bucket);
+};
+
+// 在作用域結束時記錄經過的 cycles
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : stage_(stage), start_(Profiler::now()) {}
+    ~ProfileScope() { Profiler::record(stage_, Profiler::now() - start_); }
+    
+private:
+    ProfileStage stage_;
+    uint64_t start_;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if APP_PROFILING
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(stage)
+#define PROFILE_RECORD(stage, cycles) Profiler::record((stage), (cycles))
+#else
+#define PROFILE_SCOPE(stage) do {} while (0)
+#define PROFILE_RECORD(stage, cycles) do {} while (0)
+#endif
+
+#endif // PROFILER_H
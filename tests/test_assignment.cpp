@@ -0,0 +1,127 @@
+/*
+ * test_assignment.cpp - 匈牙利演算法測試
+ *
+ * 隨機矩形矩陣 (含負成本與大量同值) 的解與暴力列舉的最小成本比較。
+ */
+
+#include "test_common.h"
+#include "assignment.h"
+#include <math.h>
+
+#define MAX_BRUTE_DIM 7
+
+// 暴力列舉: 短邊每個元素指派到長邊的不同元素，回傳最小總成本
+static float bruteForce(const float* cost, int rows, int cols, int r, bool* used) {
+    if (r == rows) return 0.0f;
+    float best = INFINITY;
+    if (rows > cols) {
+        // 列多於欄: 允許此列不指派，但已指派列數不能超過欄數 (由 used 控制)
+        int remaining_cols = 0;
+        for (int c = 0; c < cols; c++) remaining_cols += used[c] ? 0 : 1;
+        if (rows - r > remaining_cols) {
+            best = bruteForce(cost, rows, cols, r + 1, used);
+        }
+    }
+    for (int c = 0; c < cols; c++) {
+        if (used[c]) continue;
+        used[c] = true;
+        float total = cost[r * cols + c] + bruteForce(cost, rows, cols, r + 1, used);
+        used[c] = false;
+        if (total < best) best = total;
+    }
+    return best;
+}
+
+static void checkMatrix(const float* cost, int rows, int cols) {
+    int row_to_col[MAX_BRUTE_DIM];
+    float total = Assignment::solveMin(cost, rows, cols, row_to_col);
+    
+    bool used[MAX_BRUTE_DIM] = {};
+    float expected = bruteForce(cost, rows, cols, 0, used);
+    
+    // 一對一且短邊全部指派，回傳值等於所選元素的和
+    bool col_used[MAX_BRUTE_DIM] = {};
+    int assigned = 0;
+    float sum = 0.0f;
+    bool valid = true;
+    for (int r = 0; r < rows; r++) {
+        int c = row_to_col[r];
+        if (c < 0) continue;
+        if (c >= cols || col_used[c]) valid = false;
+        else col_used[c] = true;
+        sum += cost[r * cols + c];
+        assigned++;
+    }
+    TEST_CHECK_MSG(valid, "%dx%d: assignment is not one-to-one", rows, cols);
+    TEST_CHECK_MSG(assigned == (rows < cols ? rows : cols), "%dx%d: %d assigned", rows, cols, assigned);
+    TEST_CHECK_MSG(fabsf(sum - total) <= 1e-4f, "%dx%d: returned %f, assignment sums to %f",
+                   rows, cols, total, sum);
+    TEST_CHECK_MSG(fabsf(total - expected) <= 1e-4f, "%dx%d: cost %f, optimum %f",
+                   rows, cols, total, expected);
+}
+
+static void testMatchesBruteForce() {
+    TestRng rng(300);
+    float cost[MAX_BRUTE_DIM * MAX_BRUTE_DIM];
+    for (int t = 0; t < 300; t++) {
+        int rows = 1 + rng.below(MAX_BRUTE_DIM);
+        int cols = 1 + rng.below(MAX_BRUTE_DIM);
+        for (int i = 0; i < rows * cols; i++) {
+            switch (t % 3) {
+                case 0: cost[i] = rng.uniform(); break;                  // 1 - similarity
+                case 1: cost[i] = rng.uniform() * 2.0f - 1.0f; break;    // 含負成本
+                default: cost[i] = (float)rng.below(3); break;           // 大量同值
+            }
+        }
+        checkMatrix(cost, rows, cols);
+    }
+}
+
+static void testNewPersonColumns() {
+    // matchFrame 的形狀: 相似度欄 + 每個查詢一個「新人物」欄 (成本 -threshold)
+    // 兩個查詢都最像同一人時，只有一個能取得該 ID
+    const float threshold = 0.6f;
+    const int rows = 2, gallery = 2, cols = gallery + rows;
+    const float similarity[rows][gallery] = {{0.9f, 0.2f}, {0.8f, 0.1f}};
+    float cost[rows * cols];
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (c < gallery) cost[r * cols + c] = -similarity[r][c];
+            else cost[r * cols + c] = -threshold;
+        }
+    }
+    int row_to_col[rows];
+    Assignment::solveMin(cost, rows, cols, row_to_col);
+    TEST_CHECK(row_to_col[0] == 0);
+    TEST_CHECK(row_to_col[1] >= gallery);
+    checkMatrix(cost, rows, cols);
+}
+
+static void testLimits() {
+    static float cost[(ASSIGNMENT_MAX_SHORT + 1) * (ASSIGNMENT_MAX_SHORT + 1)];
+    static int row_to_col[ASSIGNMENT_MAX_SHORT + 1];
+    for (int i = 0; i < (ASSIGNMENT_MAX_SHORT + 1) * (ASSIGNMENT_MAX_SHORT + 1); i++) {
+        cost[i] = (float)(i % 7);
+    }
+    float total = Assignment::solveMin(cost, ASSIGNMENT_MAX_SHORT + 1, ASSIGNMENT_MAX_SHORT + 1,
+                                       row_to_col);
+    TEST_CHECK(total == 0.0f);
+    for (int r = 0; r <= ASSIGNMENT_MAX_SHORT; r++) TEST_CHECK(row_to_col[r] == -1);
+    
+    // 上限內的最大短邊仍可求解: 對角線為 0 的成本矩陣
+    for (int r = 0; r < ASSIGNMENT_MAX_SHORT; r++) {
+        for (int c = 0; c < ASSIGNMENT_MAX_SHORT; c++) {
+            cost[r * ASSIGNMENT_MAX_SHORT + c] = (r == c) ? 0.0f : 1.0f;
+        }
+    }
+    total = Assignment::solveMin(cost, ASSIGNMENT_MAX_SHORT, ASSIGNMENT_MAX_SHORT, row_to_col);
+    TEST_CHECK(total == 0.0f);
+    for (int r = 0; r < ASSIGNMENT_MAX_SHORT; r++) TEST_CHECK(row_to_col[r] == r);
+}
+
+int main() {
+    TEST_RUN(testMatchesBruteForce);
+    TEST_RUN(testNewPersonColumns);
+    TEST_RUN(testLimits);
+    return TEST_RESULT();
+}
@@ -0,0 +1,66 @@
+/*
+ * test_common.h - host 單元測試共用巨集
+ *
+ * 不依賴測試框架: 每個測試為獨立執行檔，任一 TEST_CHECK 失敗時
+ * main 回傳非 0，由 ctest 判定結果。
+ */
+
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+// 失敗時額外輸出格式化訊息
+#define TEST_CHECK_MSG(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RUN(fn) \
+    do { \
+        int failures_before = test_failures; \
+        fn(); \
+        printf("[%s] %s\n", test_failures == failures_before ? "PASS" : "FAIL", #fn); \
+    } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+// 固定種子的 LCG (測試資料需可重現)
+struct TestRng {
+    uint32_t state;
+    
+    explicit TestRng(uint32_t seed) : state(seed) {}
+    
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state;
+    }
+    
+    // [0, 1)
+    float uniform() {
+        return (float)(next() >> 8) / 16777216.0f;
+    }
+    
+    // [0, n)
+    int below(int n) {
+        return (int)((next() >> 8) % (uint32_t)n);
+    }
+};
+
+#endif // TEST_COMMON_H
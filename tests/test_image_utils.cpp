@@ -0,0 +1,310 @@
+/*
+ * test_image_utils.cpp - 前處理 kernel 測試
+ *
+ * resizeToInt8 / resizeWithLUT (Cortex-M55 上為 Helium 路徑) 與純量版本、
+ * 以及獨立寫成的參考實作比對；host 上 resizeToInt8 即為純量版本，以 Cortex-M55
+ * 工具鏈編譯同一份測試時才會比對到 Helium 路徑。
+ */
+
+#include "test_common.h"
+#include "image_utils.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+// 輸出緩衝區外圍的哨兵值，用來偵測寫出界
+#define GUARD_BYTE ((int8_t)0x5A)
+
+static std::vector<uint8_t> makeImage(int w, int h, uint32_t seed) {
+    TestRng rng(seed);
+    std::vector<uint8_t> img((size_t)w * h * 3);
+    for (size_t i = 0; i < img.size(); i++) {
+        img[i] = (uint8_t)(rng.next() >> 24);
+    }
+    return img;
+}
+
+// 參考: 最近鄰取樣 floor(x * src_w / dst_w)，再加 offset 並飽和
+static int8_t referencePixel(const std::vector<uint8_t>& src, int src_w, int src_h,
+                             int dst_w, int dst_h, int x, int y, int c, int32_t offset) {
+    int sx = (int)((int64_t)x * src_w / dst_w);
+    int sy = (int)((int64_t)y * src_h / dst_h);
+    int32_t v = (int32_t)src[((size_t)sy * src_w + sx) * 3 + c] + offset;
+    if (v < -128) v = -128;
+    if (v > 127) v = 127;
+    return (int8_t)v;
+}
+
+static void checkResize(int src_w, int src_h, int dst_w, int dst_h, int32_t offset, int dst_stride) {
+    std::vector<uint8_t> src = makeImage(src_w, src_h, (uint32_t)(src_w * 131 + src_h));
+    int stride = dst_stride ? dst_stride : dst_w * 3;
+    std::vector<int8_t> fast((size_t)stride * dst_h, GUARD_BYTE);
+    std::vector<int8_t> scalar((size_t)stride * dst_h, GUARD_BYTE);
+    
+    ImageUtils::resizeToInt8(src.data(), src_w, src_h, fast.data(), dst_w, dst_h, offset, dst_stride);
+    ImageUtils::resizeToInt8Scalar(src.data(), src_w, src_h, scalar.data(), dst_w, dst_h, offset, dst_stride);
+    
+    int mismatches = 0;
+    int ref_mismatches = 0;
+    int guard_overwrites = 0;
+    for (int y = 0; y < dst_h; y++) {
+        for (int i = 0; i < stride; i++) {
+            size_t idx = (size_t)y * stride + i;
+            if (fast[idx] != scalar[idx]) mismatches++;
+            if (i >= dst_w * 3) {
+                if (fast[idx] != GUARD_BYTE) guard_overwrites++;
+                continue;
+            }
+            if (scalar[idx] != referencePixel(src, src_w, src_h, dst_w, dst_h, i / 3, y, i % 3, offset)) {
+                ref_mismatches++;
+            }
+        }
+    }
+    TEST_CHECK_MSG(mismatches == 0, "%dx%d -> %dx%d offset %d stride %d: %d bytes differ from scalar",
+                   src_w, src_h, dst_w, dst_h, (int)offset, stride, mismatches);
+    TEST_CHECK_MSG(ref_mismatches == 0, "%dx%d -> %dx%d offset %d: %d bytes differ from reference",
+                   src_w, src_h, dst_w, dst_h, (int)offset, ref_mismatches);
+    TEST_CHECK_MSG(guard_overwrites == 0, "%dx%d -> %dx%d stride %d: %d bytes written past the row",
+                   src_w, src_h, dst_w, dst_h, stride, guard_overwrites);
+}
+
+static void testResizeMatchesScalar() {
+    // 縮小、放大、非整數比例、寬度非 8 的倍數 (Helium tail predication)
+    checkResize(640, 480, 256, 256, -128, 0);
+    checkResize(640, 480, 320, 320, -128, 0);
+    checkResize(37, 23, 13, 11, -128, 0);
+    checkResize(5, 4, 16, 9, -128, 0);
+    checkResize(640, 480, 1, 1, -128, 0);
+    // 超過 Helium 路徑支援的寬度時退回純量
+    checkResize(1200, 8, 1100, 4, -128, 0);
+}
+
+static void testResizeSaturates() {
+    checkResize(64, 48, 32, 24, 0, 0);
+    checkResize(64, 48, 32, 24, 100, 0);
+    checkResize(64, 48, 32, 24, -200, 0);
+}
+
+static void testResizeDestinationStride() {
+    // letterbox 以 dst_w * 3 之外的 stride 寫入內容區域
+    checkResize(640, 480, 256, 192, -128, 256 * 3);
+    checkResize(640, 480, 190, 256, -128, 256 * 3);
+    checkResize(37, 23, 13, 11, -128, 13 * 3 + 5);
+}
+
+static void testLetterbox() {
+    const int src_w = 640, src_h = 480, dst_w = 256, dst_h = 256;
+    const int8_t pad = 114 - 128;
+    std::vector<uint8_t> src = makeImage(src_w, src_h, 7);
+    std::vector<int8_t> dst((size_t)dst_w * dst_h * 3, GUARD_BYTE);
+    
+    ImageTransform t = ImageUtils::letterboxToInt8(src.data(), src_w, src_h, dst.data(),
+                                                   dst_w, dst_h, -128, pad);
+    
+    // 640x480 -> 256x192，上下各 32 列 padding
+    const int new_w = 256, new_h = 192, pad_x = 0, pad_y = 32;
+    TEST_CHECK(t.pad_x == (float)pad_x);
+    TEST_CHECK(t.pad_y == (float)pad_y);
+    TEST_CHECK(t.scale_x == (float)src_w / new_w);
+    TEST_CHECK(t.scale_y == (float)src_h / new_h);
+    
+    int pad_errors = 0;
+    int content_errors = 0;
+    for (int y = 0; y < dst_h; y++) {
+        for (int x = 0; x < dst_w; x++) {
+            for (int c = 0; c < 3; c++) {
+                int8_t v = dst[((size_t)y * dst_w + x) * 3 + c];
+                bool inside = y >= pad_y && y < pad_y + new_h && x >= pad_x && x < pad_x + new_w;
+                if (!inside) {
+                    if (v != pad) pad_errors++;
+                } else if (v != referencePixel(src, src_w, src_h, new_w, new_h,
+                                               x - pad_x, y - pad_y, c, -128)) {
+                    content_errors++;
+                }
+            }
+        }
+    }
+    TEST_CHECK_MSG(pad_errors == 0, "%d padding bytes wrong", pad_errors);
+    TEST_CHECK_MSG(content_errors == 0, "%d content bytes wrong", content_errors);
+    
+    // 內容區域的像素中心經轉換後落在原始影像的取樣像素內
+    for (int x = pad_x; x < pad_x + new_w; x += 17) {
+        float sx = t.toSourceX(x + 0.5f);
+        int sample = (int)((int64_t)(x - pad_x) * src_w / new_w);
+        TEST_CHECK_MSG(sx >= sample && sx < sample + t.scale_x + 1.0f, "x %d -> %f, sample %d", x, sx, sample);
+    }
+}
+
+static void testLetterboxPortrait() {
+    // 直式影像: 左右 padding，內容以 dst_w * 3 的 stride 寫入
+    const int src_w = 240, src_h = 320, dst_w = 256, dst_h = 256;
+    const int8_t pad = -14;
+    std::vector<uint8_t> src = makeImage(src_w, src_h, 11);
+    std::vector<int8_t> dst((size_t)dst_w * dst_h * 3, GUARD_BYTE);
+    
+    ImageTransform t = ImageUtils::letterboxToInt8(src.data(), src_w, src_h, dst.data(),
+                                                   dst_w, dst_h, -128, pad);
+    const int new_w = 192, new_h = 256, pad_x = 32, pad_y = 0;
+    TEST_CHECK(t.pad_x == (float)pad_x);
+    TEST_CHECK(t.pad_y == (float)pad_y);
+    
+    int errors = 0;
+    for (int y = 0; y < dst_h; y++) {
+        for (int x = 0; x < dst_w; x++) {
+            for (int c = 0; c < 3; c++) {
+                int8_t v = dst[((size_t)y * dst_w + x) * 3 + c];
+                bool inside = x >= pad_x && x < pad_x + new_w;
+                int8_t expected = inside
+                    ? referencePixel(src, src_w, src_h, new_w, new_h, x - pad_x, y - pad_y, c, -128)
+                    : pad;
+                if (v != expected) errors++;
+            }
+        }
+    }
+    TEST_CHECK_MSG(errors == 0, "%d bytes wrong", errors);
+}
+
+// 參考: buildNormalizeLUT 文件中的 float 運算與 roundf，逐像素計算 (不經查表)
+static int8_t referenceNormalize(uint8_t pixel, float scale, int32_t zero_point) {
+    float normalized = (pixel / 255.0f - 0.5f) * 2.0f;
+    int32_t q = (int32_t)roundf(normalized / scale) + zero_point;
+    if (q < -128) q = -128;
+    if (q > 127) q = 127;
+    return (int8_t)q;
+}
+
+// 合理性檢查用: 以 double 正規化後量化，與 float 運算只在四捨五入邊界上可能差 1
+static int referenceNormalizeDouble(uint8_t pixel, double scale, int32_t zero_point) {
+    double normalized = pixel / 127.5 - 1.0;
+    long q = lround(normalized / scale) + zero_point;
+    if (q < -128) q = -128;
+    if (q > 127) q = 127;
+    return (int)q;
+}
+
+struct QuantParams {
+    float scale;
+    int32_t zero_point;
+};
+
+// 典型的 [-1, 1] 輸入量化，以及會飽和的參數
+static const QuantParams kQuantParams[] = {
+    {1.0f / 128.0f, 0},
+    {2.0f / 255.0f, -1},
+    {0.0079f, 3},
+    {0.02f, 10},
+};
+
+static void testNormalizeLUTExact() {
+    for (const QuantParams& q : kQuantParams) {
+        int8_t lut[256];
+        ImageUtils::buildNormalizeLUT(q.scale, q.zero_point, lut);
+        int errors = 0;
+        for (int v = 0; v < 256; v++) {
+            if (lut[v] != referenceNormalize((uint8_t)v, q.scale, q.zero_point)) errors++;
+        }
+        TEST_CHECK_MSG(errors == 0, "scale %f zp %d: %d of 256 entries differ",
+                       q.scale, (int)q.zero_point, errors);
+    }
+}
+
+static void testNormalizeLUTNearDouble() {
+    // 合理性檢查 (非精確): 查表與 double 運算的差距不超過 1
+    for (const QuantParams& q : kQuantParams) {
+        int8_t lut[256];
+        ImageUtils::buildNormalizeLUT(q.scale, q.zero_point, lut);
+        int max_diff = 0;
+        for (int v = 0; v < 256; v++) {
+            int diff = abs(lut[v] - referenceNormalizeDouble((uint8_t)v, q.scale, q.zero_point));
+            if (diff > max_diff) max_diff = diff;
+        }
+        TEST_CHECK_MSG(max_diff <= 1, "scale %f zp %d: max diff %d",
+                       q.scale, (int)q.zero_point, max_diff);
+    }
+}
+
+static void checkResizeWithLUT(int img_w, int img_h, int roi_x, int roi_y, int roi_w, int roi_h,
+                               int dst_w, int dst_h, const QuantParams& q) {
+    std::vector<uint8_t> img = makeImage(img_w, img_h, (uint32_t)(roi_w * 977 + roi_h));
+    ImageView roi = {img.data(), img_w * 3, roi_x, roi_y, roi_w, roi_h};
+    int8_t lut[256];
+    ImageUtils::buildNormalizeLUT(q.scale, q.zero_point, lut);
+    
+    std::vector<int8_t> fast((size_t)dst_w * dst_h * 3 + 16, GUARD_BYTE);
+    std::vector<int8_t> scalar((size_t)dst_w * dst_h * 3 + 16, GUARD_BYTE);
+    ImageUtils::resizeWithLUT(roi, fast.data(), dst_w, dst_h, lut);
+    ImageUtils::resizeWithLUTScalar(roi, scalar.data(), dst_w, dst_h, lut);
+    
+    int mismatches = 0;
+    int ref_errors = 0;
+    for (int y = 0; y < dst_h; y++) {
+        for (int x = 0; x < dst_w; x++) {
+            int sx = roi_x + (int)((int64_t)x * roi_w / dst_w);
+            int sy = roi_y + (int)((int64_t)y * roi_h / dst_h);
+            for (int c = 0; c < 3; c++) {
+                size_t idx = ((size_t)y * dst_w + x) * 3 + c;
+                if (fast[idx] != scalar[idx]) mismatches++;
+                uint8_t pixel = img[((size_t)sy * img_w + sx) * 3 + c];
+                if (scalar[idx] != referenceNormalize(pixel, q.scale, q.zero_point)) ref_errors++;
+            }
+        }
+    }
+    for (size_t i = (size_t)dst_w * dst_h * 3; i < fast.size(); i++) {
+        TEST_CHECK(fast[i] == GUARD_BYTE);
+    }
+    TEST_CHECK_MSG(mismatches == 0, "ROI %dx%d -> %dx%d: %d bytes differ from scalar",
+                   roi_w, roi_h, dst_w, dst_h, mismatches);
+    TEST_CHECK_MSG(ref_errors == 0, "ROI %dx%d -> %dx%d: %d bytes differ from the reference",
+                   roi_w, roi_h, dst_w, dst_h, ref_errors);
+}
+
+static void testResizeWithLUT() {
+    for (const QuantParams& q : kQuantParams) {
+        // Re-ID 輸入尺寸，ROI 位於影像中間 (stride 為整張影像)
+        checkResizeWithLUT(640, 480, 211, 37, 57, 143, 128, 256, q);
+        checkResizeWithLUT(640, 480, 0, 0, 300, 480, 128, 256, q);
+        checkResizeWithLUT(640, 480, 639, 479, 1, 1, 128, 256, q);
+        checkResizeWithLUT(640, 480, 5, 9, 333, 17, 13, 7, q);
+    }
+}
+
+static void testResizeWithLUTAllValues() {
+    // 一列涵蓋所有 byte 值，確認每個查表位置都與參考完全相同
+    uint8_t row[256 * 3];
+    for (int v = 0; v < 256; v++) {
+        row[v * 3 + 0] = (uint8_t)v;
+        row[v * 3 + 1] = (uint8_t)(255 - v);
+        row[v * 3 + 2] = (uint8_t)(v ^ 0x5A);
+    }
+    ImageView view = {row, 256 * 3, 0, 0, 256, 1};
+    for (const QuantParams& q : kQuantParams) {
+        int8_t lut[256];
+        ImageUtils::buildNormalizeLUT(q.scale, q.zero_point, lut);
+        int8_t fast[256 * 3];
+        int8_t scalar[256 * 3];
+        ImageUtils::resizeWithLUT(view, fast, 256, 1, lut);
+        ImageUtils::resizeWithLUTScalar(view, scalar, 256, 1, lut);
+        
+        int errors = 0;
+        for (int i = 0; i < 256 * 3; i++) {
+            int8_t expected = referenceNormalize(row[i], q.scale, q.zero_point);
+            if (fast[i] != expected || scalar[i] != expected) errors++;
+        }
+        TEST_CHECK_MSG(errors == 0, "scale %f zp %d: %d bytes wrong",
+                       q.scale, (int)q.zero_point, errors);
+    }
+}
+
+int main() {
+    TEST_RUN(testResizeMatchesScalar);
+    TEST_RUN(testResizeSaturates);
+    TEST_RUN(testResizeDestinationStride);
+    TEST_RUN(testLetterbox);
+    TEST_RUN(testLetterboxPortrait);
+    TEST_RUN(testNormalizeLUTExact);
+    TEST_RUN(testNormalizeLUTNearDouble);
+    TEST_RUN(testResizeWithLUT);
+    TEST_RUN(testResizeWithLUTAllValues);
+    return TEST_RESULT();
+}
@@ -0,0 +1,326 @@
+/*
+ * test_reid_gallery.cpp - Re-ID gallery 測試
+ *
+ * 以隨機 L2 正規化特徵模擬身分，檢查兩階段搜尋相對暴力搜尋的召回率、
+ * EMA 模板對外觀漂移的追隨、樣本的收錄條件，以及存檔 / 載入。
+ */
+
+#include "test_common.h"
+#include "reid_gallery.h"
+#include "reid_kernels.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static void normalize(float* v) {
+    double norm = 0.0;
+    for (int i = 0; i < REID_FEATURE_DIM; i++) norm += (double)v[i] * v[i];
+    float inv = (float)(1.0 / sqrt(norm));
+    for (int i = 0; i < REID_FEATURE_DIM; i++) v[i] *= inv;
+}
+
+static void randomFeature(TestRng& rng, float* v) {
+    for (int i = 0; i < REID_FEATURE_DIM; i++) v[i] = rng.uniform() - 0.5f;
+    normalize(v);
+}
+
+// 與 base 相似度約為 similarity 的觀測: base 加上正交的隨機方向
+static void observe(TestRng& rng, const float* base, float similarity, float* out) {
+    float noise[REID_FEATURE_DIM];
+    randomFeature(rng, noise);
+    float dot = 0.0f;
+    for (int i = 0; i < REID_FEATURE_DIM; i++) dot += noise[i] * base[i];
+    for (int i = 0; i < REID_FEATURE_DIM; i++) noise[i] -= dot * base[i];
+    normalize(noise);
+    float ortho = sqrtf(1.0f - similarity * similarity);
+    for (int i = 0; i < REID_FEATURE_DIM; i++) out[i] = similarity * base[i] + ortho * noise[i];
+    normalize(out);
+}
+
+static float dot(const float* a, const float* b) {
+    double acc = 0.0;
+    for (int i = 0; i < REID_FEATURE_DIM; i++) acc += (double)a[i] * b[i];
+    return (float)acc;
+}
+
+static void testCoarseSearchRecall() {
+    // 填滿預設預算，查詢與目標的相似度約 0.62 (接近匹配門檻)
+    const int num_queries = 200;
+    const float query_similarity = 0.62f;
+    ReIDGallery gallery;
+    TEST_CHECK(gallery.init(REID_GALLERY_POOL_SIZE));
+    const int n = gallery.capacity();
+    TEST_CHECK(n > REID_GALLERY_RERANK_K);
+    
+    TestRng rng(2024);
+    std::vector<float> identities((size_t)n * REID_FEATURE_DIM);
+    for (int i = 0; i < n; i++) {
+        float* id = &identities[(size_t)i * REID_FEATURE_DIM];
+        randomFeature(rng, id);
+        TEST_CHECK(gallery.add(id, i, 0, nullptr) == i);
+    }
+    TEST_CHECK(gallery.size() == n);
+    
+    int hits = 0;
+    int brute_force_hits = 0;
+    uint32_t rescored_before = gallery.rescoredCount();
+    float query[REID_FEATURE_DIM];
+    for (int q = 0; q < num_queries; q++) {
+        int target = rng.below(n);
+        observe(rng, &identities[(size_t)target * REID_FEATURE_DIM], query_similarity, query);
+        
+        // 暴力搜尋 (float) 作為參考
+        int best = 0;
+        float best_similarity = -2.0f;
+        for (int i = 0; i < n; i++) {
+            float s = dot(query, &identities[(size_t)i * REID_FEATURE_DIM]);
+            if (s > best_similarity) {
+                best_similarity = s;
+                best = i;
+            }
+        }
+        if (best == target) brute_force_hits++;
+        
+        float similarity = 0.0f;
+        int slot = gallery.search(query, &similarity);
+        if (slot >= 0 && gallery.personId(slot) == best) hits++;
+    }
+    uint32_t rescored = gallery.rescoredCount() - rescored_before;
+    
+    printf("  %d identities: two-stage %d/%d, brute force %d/%d, %.1f rescored per query\n",
+           n, hits, num_queries, brute_force_hits, num_queries, (float)rescored / num_queries);
+    TEST_CHECK(brute_force_hits == num_queries);
+    TEST_CHECK_MSG(hits >= num_queries * 97 / 100, "recall %d/%d", hits, num_queries);
+    TEST_CHECK(rescored == (uint32_t)num_queries * REID_GALLERY_RERANK_K);
+}
+
+static void testSmallGalleryIsExhaustive() {
+    // K 筆以內全部精算，結果與暴力搜尋完全一致
+    ReIDGallery gallery;
+    TEST_CHECK(gallery.init(REID_GALLERY_POOL_SIZE));
+    TestRng rng(5);
+    float ids[REID_GALLERY_RERANK_K][REID_FEATURE_DIM];
+    for (int i = 0; i < REID_GALLERY_RERANK_K; i++) {
+        randomFeature(rng, ids[i]);
+        gallery.add(ids[i], 100 + i, 0, nullptr);
+    }
+    float query[REID_FEATURE_DIM];
+    for (int q = 0; q < 50; q++) {
+        int target = rng.below(REID_GALLERY_RERANK_K);
+        observe(rng, ids[target], 0.3f, query);
+        float similarity = 0.0f;
+        int slot = gallery.search(query, &similarity);
+        TEST_CHECK(slot >= 0 && gallery.personId(slot) == 100 + target);
+        TEST_CHECK(fabsf(similarity - dot(query, ids[target])) <= 0.01f);
+    }
+}
+
+static void testEvictsLeastRecentlySeen() {
+    ReIDGallery gallery;
+    TEST_CHECK(gallery.init(4 * ReIDGallery::bytesPerEntry() + 256));
+    TEST_CHECK(gallery.capacity() == 4);
+    TestRng rng(9);
+    float v[REID_FEATURE_DIM];
+    for (int i = 0; i < 4; i++) {
+        randomFeature(rng, v);
+        gallery.add(v, i, 10 + i, nullptr);
+    }
+    gallery.touch(0, 20);
+    
+    int evicted = -2;
+    randomFeature(rng, v);
+    int slot = gallery.add(v, 4, 21, &evicted);
+    TEST_CHECK(evicted == 1);
+    TEST_CHECK(slot == 1);
+    TEST_CHECK(gallery.size() == 4);
+    TEST_CHECK(gallery.findPerson(4) == 1);
+    TEST_CHECK(gallery.findPerson(1) == -1);
+}
+
+static void testTemplateFollowsDrift() {
+    // 外觀在 100 幀內線性漂移到無關的向量，每幀匹配後更新
+    ReIDGallery gallery;
+    TEST_CHECK(gallery.init(ReIDGallery::bytesPerEntry() + 256));
+    TestRng rng(18);
+    float start[REID_FEATURE_DIM], end[REID_FEATURE_DIM], obs[REID_FEATURE_DIM];
+    randomFeature(rng, start);
+    randomFeature(rng, end);
+    int slot = gallery.add(start, 1, 0, nullptr);
+    
+    float min_similarity = 2.0f;
+    for (int f = 1; f <= 100; f++) {
+        float t = f / 100.0f;
+        for (int i = 0; i < REID_FEATURE_DIM; i++) obs[i] = (1.0f - t) * start[i] + t * end[i];
+        normalize(obs);
+        
+        float similarity = 0.0f;
+        TEST_CHECK(gallery.search(obs, &similarity) == slot);
+        if (similarity < min_similarity) min_similarity = similarity;
+        gallery.update(slot, obs, f);
+    }
+    
+    // 凍結的首次外觀最後幾乎不相似
+    float frozen = dot(start, obs);
+    printf("  min EMA similarity %.3f, frozen template %.3f\n", min_similarity, frozen);
+    TEST_CHECK(min_similarity >= 0.9f);
+    TEST_CHECK(fabsf(frozen) < 0.2f);
+    TEST_CHECK(gallery.lastSeen(slot) == 100);
+}
+
+static void testExemplarDiversity() {
+    ReIDGallery gallery;
+    TEST_CHECK(gallery.init(ReIDGallery::bytesPerEntry() + 256));
+    TestRng rng(81);
+    float base[REID_FEATURE_DIM], obs[REID_FEATURE_DIM];
+    randomFeature(rng, base);
+    int slot = gallery.add(base, 1, 0, nullptr);
+    
+    // 與模板相近的觀測不收為樣本
+    for (int f = 1; f <= 20; f++) {
+        observe(rng, base, 0.95f, obs);
+        gallery.update(slot, obs, f);
+    }
+    TEST_CHECK(gallery.exemplarCount(slot) == 0);
+    
+    // 外觀差異大的觀測收為樣本，之後邊界區間的查詢以樣本補足
+    float pose[REID_FEATURE_DIM];
+    observe(rng, base, 0.5f, pose);
+    gallery.update(slot, pose, 21);
+    float similarity = 0.0f;
+    gallery.setBorderlineBand(0.3f, 0.9f);
+    gallery.search(pose, &similarity);
+#if REID_GALLERY_EXEMPLARS > 0
+    TEST_CHECK(gallery.exemplarCount(slot) == 1);
+    TEST_CHECK_MSG(similarity > 0.95f, "exemplar similarity %.3f", similarity);
+    
+    // 與既有樣本相近的觀測不重複收錄
+    observe(rng, pose, 0.95f, obs);
+    gallery.update(slot, obs, 22);
+    TEST_CHECK(gallery.exemplarCount(slot) == 1);
+#else
+    TEST_CHECK(gallery.exemplarCount(slot) == 0);
+    TEST_CHECK(similarity < 0.9f);
+#endif
+}
+
+#define TEST_GALLERY_FILE "test_reid_gallery.bin"
+
+static void testSaveLoadRoundTrip() {
+    // gallery pool 為靜態共用: 記錄搜尋結果並存檔後，以另一個實例載入
+    const int n = 300;
+    const int num_queries = 50;
+    TestRng rng(19);
+    std::vector<float> identities((size_t)n * REID_FEATURE_DIM);
+    std::vector<float> queries((size_t)num_queries * REID_FEATURE_DIM);
+    int expected_ids[num_queries];
+    float expected_similarity[num_queries];
+    float obs[REID_FEATURE_DIM];
+    
+    {
+        ReIDGallery gallery;
+        TEST_CHECK(gallery.init(n * ReIDGallery::bytesPerEntry() + 256));
+        gallery.setBorderlineBand(0.3f, 0.9f);
+        for (int i = 0; i < n; i++) {
+            float* id = &identities[(size_t)i * REID_FEATURE_DIM];
+            randomFeature(rng, id);
+            gallery.add(id, 1000 + i, i, nullptr);
+            // 部分身分帶有樣本
+            if (i % 3 == 0) {
+                observe(rng, id, 0.5f, obs);
+                gallery.update(i, obs, n + i);
+            }
+        }
+        for (int q = 0; q < num_queries; q++) {
+            float* query = &queries[(size_t)q * REID_FEATURE_DIM];
+            observe(rng, &identities[(size_t)rng.below(n) * REID_FEATURE_DIM], 0.6f, query);
+            int slot = gallery.search(query, &expected_similarity[q]);
+            expected_ids[q] = slot >= 0 ? gallery.personId(slot) : -1;
+        }
+        TEST_CHECK(gallery.save(TEST_GALLERY_FILE, 5000, REID_GALLERY_INT8 != 0));
+    }
+    
+    ReIDGallery loaded;
+    TEST_CHECK(loaded.init(n * ReIDGallery::bytesPerEntry() + 256));
+    loaded.setBorderlineBand(0.3f, 0.9f);
+    int32_t next_person_id = 0;
+    TEST_CHECK(loaded.load(TEST_GALLERY_FILE, &next_person_id));
+    TEST_CHECK(next_person_id == 5000);
+    TEST_CHECK(loaded.size() == n);
+    
+    // 以儲存格式相同的檔案載入，搜尋結果完全一致
+    int mismatches = 0;
+    for (int q = 0; q < num_queries; q++) {
+        float similarity = 0.0f;
+        int slot = loaded.search(&queries[(size_t)q * REID_FEATURE_DIM], &similarity);
+        int id = slot >= 0 ? loaded.personId(slot) : -1;
+        if (id != expected_ids[q] || similarity != expected_similarity[q]) mismatches++;
+    }
+    TEST_CHECK_MSG(mismatches == 0, "%d/%d searches differ after reload", mismatches, num_queries);
+    for (int i = 0; i < n; i++) {
+        TEST_CHECK(loaded.exemplarCount(i) == (i % 3 == 0 && REID_GALLERY_EXEMPLARS > 0 ? 1 : 0));
+    }
+    remove(TEST_GALLERY_FILE);
+    
+#if !REID_GALLERY_INT8
+    // float gallery 載入 int8 檔案: 向量經量化，搜尋到的 ID 仍一致
+    TEST_CHECK(loaded.save(TEST_GALLERY_FILE, 5000, true));
+    ReIDGallery converted;
+    TEST_CHECK(converted.init(n * ReIDGallery::bytesPerEntry() + 256));
+    converted.setBorderlineBand(0.3f, 0.9f);
+    TEST_CHECK(converted.load(TEST_GALLERY_FILE, nullptr));
+    mismatches = 0;
+    for (int q = 0; q < num_queries; q++) {
+        float similarity = 0.0f;
+        int slot = converted.search(&queries[(size_t)q * REID_FEATURE_DIM], &similarity);
+        int id = slot >= 0 ? converted.personId(slot) : -1;
+        if (id != expected_ids[q] || fabsf(similarity - expected_similarity[q]) > 0.01f) mismatches++;
+    }
+    TEST_CHECK_MSG(mismatches == 0, "%d/%d searches differ after int8 reload", mismatches, num_queries);
+    remove(TEST_GALLERY_FILE);
+#endif
+}
+
+static void testLoadedEntriesEvictFirst() {
+    // 上次執行的幀號 (較大) 不沿用: 載入的資料先於本次新增的資料被淘汰
+    TestRng rng(91);
+    float v[REID_FEATURE_DIM];
+    {
+        ReIDGallery gallery;
+        TEST_CHECK(gallery.init(4 * ReIDGallery::bytesPerEntry() + 256));
+        for (int i = 0; i < 2; i++) {
+            randomFeature(rng, v);
+            gallery.add(v, i, 100000 + i, nullptr);
+        }
+        TEST_CHECK(gallery.save(TEST_GALLERY_FILE, 2, REID_GALLERY_INT8 != 0));
+    }
+    
+    ReIDGallery gallery;
+    TEST_CHECK(gallery.init(4 * ReIDGallery::bytesPerEntry() + 256));
+    TEST_CHECK(gallery.load(TEST_GALLERY_FILE, nullptr));
+    TEST_CHECK(gallery.lastSeen(0) == 0 && gallery.lastSeen(1) == 0);
+    for (int i = 2; i < 4; i++) {
+        randomFeature(rng, v);
+        gallery.add(v, i, i, nullptr);
+    }
+    
+    int evicted[2];
+    for (int k = 0; k < 2; k++) {
+        randomFeature(rng, v);
+        gallery.add(v, 4 + k, 10 + k, &evicted[k]);
+    }
+    TEST_CHECK(evicted[0] == 0);
+    TEST_CHECK(evicted[1] == 1);
+    remove(TEST_GALLERY_FILE);
+}
+
+int main() {
+    TEST_RUN(testCoarseSearchRecall);
+    TEST_RUN(testSmallGalleryIsExhaustive);
+    TEST_RUN(testEvictsLeastRecentlySeen);
+    TEST_RUN(testTemplateFollowsDrift);
+    TEST_RUN(testExemplarDiversity);
+    TEST_RUN(testSaveLoadRoundTrip);
+    TEST_RUN(testLoadedEntriesEvictFirst);
+    return TEST_RESULT();
+}
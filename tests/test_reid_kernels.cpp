@@ -0,0 +1,154 @@
+/*
+ * test_reid_kernels.cpp - Re-ID 相似度 kernel 測試
+ *
+ * int8 相似度 (per-vector 對稱量化) 相對 float 參考的誤差上限，
+ * 以及 SIMD kernel 與純量版本一致 (host 上兩者相同，Cortex-M55 上為 Helium)。
+ */
+
+#include "test_common.h"
+#include "reid.h"
+#include "reid_kernels.h"
+#include <math.h>
+
+#define NUM_PAIRS 400
+
+enum FeatureShape {
+    FEATURE_SIGNED = 0,     // 對稱分布
+    FEATURE_NONNEGATIVE,    // ReLU + pooling 後的非負特徵
+    FEATURE_PEAKY,          // 少數維度主導 (量化 scale 大，誤差最大)
+    NUM_FEATURE_SHAPES
+};
+
+static void normalize(float* v, int dim) {
+    double norm = 0.0;
+    for (int i = 0; i < dim; i++) norm += (double)v[i] * v[i];
+    float inv = (float)(1.0 / sqrt(norm));
+    for (int i = 0; i < dim; i++) v[i] *= inv;
+}
+
+static float sampleValue(TestRng& rng, FeatureShape shape) {
+    float u = rng.uniform();
+    switch (shape) {
+        case FEATURE_NONNEGATIVE: return u * u;
+        case FEATURE_PEAKY: return rng.below(32) == 0 ? 8.0f * (u - 0.5f) : (u - 0.5f) * 0.2f;
+        default: return u - 0.5f;
+    }
+}
+
+// b = a + noise * n (兩者皆 L2 正規化)，noise 由 0 到大涵蓋高/低相似度
+static void makePair(TestRng& rng, FeatureShape shape, float noise, float* a, float* b) {
+    for (int i = 0; i < REID_FEATURE_DIM; i++) {
+        a[i] = sampleValue(rng, shape);
+        b[i] = a[i] + noise * sampleValue(rng, shape);
+    }
+    normalize(a, REID_FEATURE_DIM);
+    normalize(b, REID_FEATURE_DIM);
+}
+
+static double referenceDot(const float* a, const float* b, int dim) {
+    double acc = 0.0;
+    for (int i = 0; i < dim; i++) acc += (double)a[i] * b[i];
+    return acc;
+}
+
+static void testInt8SimilarityError() {
+    static float a[REID_FEATURE_DIM];
+    static float b[REID_FEATURE_DIM];
+    static int8_t qa[REID_FEATURE_DIM];
+    static int8_t qb[REID_FEATURE_DIM];
+    const float noise_levels[] = {0.0f, 0.1f, 0.3f, 1.0f, 4.0f};
+    TestRng rng(0x1234u);
+    
+    for (int shape = 0; shape < NUM_FEATURE_SHAPES; shape++) {
+        double max_error = 0.0;
+        double sum_error = 0.0;
+        for (int t = 0; t < NUM_PAIRS; t++) {
+            makePair(rng, (FeatureShape)shape, noise_levels[t % 5], a, b);
+            float scale_a = ReIDKernels::quantize(a, qa, REID_FEATURE_DIM);
+            float scale_b = ReIDKernels::quantize(b, qb, REID_FEATURE_DIM);
+            int32_t dot_q = ReIDKernels::dotInt8(qa, qb, REID_FEATURE_DIM);
+            double error = fabs(dot_q * (double)scale_a * scale_b - referenceDot(a, b, REID_FEATURE_DIM));
+            if (error > max_error) max_error = error;
+            sum_error += error;
+        }
+        printf("  shape %d: int8 similarity error max %.5f mean %.5f\n",
+               shape, max_error, sum_error / NUM_PAIRS);
+        TEST_CHECK_MSG(max_error <= REID_INT8_SIMILARITY_TOLERANCE, "shape %d: max error %.5f > %.5f",
+                       shape, max_error, (double)REID_INT8_SIMILARITY_TOLERANCE);
+    }
+}
+
+static void testQuantizeRoundTrip() {
+    static float a[REID_FEATURE_DIM];
+    static float b[REID_FEATURE_DIM];
+    static int8_t qa[REID_FEATURE_DIM];
+    TestRng rng(42);
+    makePair(rng, FEATURE_SIGNED, 0.0f, a, b);
+    
+    float scale = ReIDKernels::quantize(a, qa, REID_FEATURE_DIM);
+    int saturated = 0;
+    for (int i = 0; i < REID_FEATURE_DIM; i++) {
+        TEST_CHECK(fabsf(qa[i] * scale - a[i]) <= scale * 0.5f + 1e-7f);
+        if (qa[i] == 127 || qa[i] == -127) saturated++;
+        TEST_CHECK(qa[i] != -128);
+    }
+    // 最大值對應 ±127
+    TEST_CHECK(saturated >= 1);
+    
+    // 全零向量: scale 0，內容為 0
+    for (int i = 0; i < REID_FEATURE_DIM; i++) a[i] = 0.0f;
+    TEST_CHECK(ReIDKernels::quantize(a, qa, REID_FEATURE_DIM) == 0.0f);
+    TEST_CHECK(ReIDKernels::dotInt8Scalar(qa, qa, REID_FEATURE_DIM) == 0);
+}
+
+static void testKernelsMatchScalar() {
+    static float a[REID_FEATURE_DIM];
+    static float b[REID_FEATURE_DIM];
+    static int8_t qa[REID_FEATURE_DIM];
+    static int8_t qb[REID_FEATURE_DIM];
+    TestRng rng(7);
+    // 完整維度與非 16 倍數的長度 (tail predication)
+    const int dims[] = {REID_FEATURE_DIM, 500, 17, 3};
+    
+    for (int d : dims) {
+        for (int t = 0; t < 20; t++) {
+            makePair(rng, (FeatureShape)(t % NUM_FEATURE_SHAPES), 0.5f, a, b);
+            float simd = ReIDKernels::dotFloat(a, b, d);
+            float scalar = ReIDKernels::dotFloatScalar(a, b, d);
+            TEST_CHECK_MSG(fabsf(simd - scalar) <= 1e-5f, "dim %d: %f vs %f", d, simd, scalar);
+            TEST_CHECK(fabs(scalar - referenceDot(a, b, d)) <= 1e-5);
+            
+            ReIDKernels::quantize(a, qa, d);
+            ReIDKernels::quantize(b, qb, d);
+            TEST_CHECK_MSG(ReIDKernels::dotInt8(qa, qb, d) == ReIDKernels::dotInt8Scalar(qa, qb, d),
+                           "dim %d", d);
+        }
+    }
+}
+
+static void testDotInt8Multi() {
+    // 多筆查詢 (含非 4 倍數的尾端) 與逐筆 dotInt8Scalar 一致
+    static int8_t queries[7 * REID_FEATURE_DIM];
+    static int8_t b[REID_FEATURE_DIM];
+    int32_t out[7];
+    TestRng rng(99);
+    for (int i = 0; i < 7 * REID_FEATURE_DIM; i++) queries[i] = (int8_t)(rng.below(255) - 127);
+    for (int i = 0; i < REID_FEATURE_DIM; i++) b[i] = (int8_t)(rng.below(255) - 127);
+    
+    for (int n = 1; n <= 7; n++) {
+        ReIDKernels::dotInt8Multi(queries, n, b, REID_FEATURE_DIM, out);
+        for (int q = 0; q < n; q++) {
+            TEST_CHECK_MSG(out[q] == ReIDKernels::dotInt8Scalar(queries + q * REID_FEATURE_DIM, b,
+                                                                REID_FEATURE_DIM),
+                           "%d queries, query %d", n, q);
+        }
+    }
+}
+
+int main() {
+    TEST_RUN(testInt8SimilarityError);
+    TEST_RUN(testQuantizeRoundTrip);
+    TEST_RUN(testKernelsMatchScalar);
+    TEST_RUN(testDotInt8Multi);
+    return TEST_RESULT();
+}
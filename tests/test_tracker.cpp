@@ -0,0 +1,154 @@
+/*
+ * test_tracker.cpp - IoU + Kalman 追蹤器測試
+ *
+ * 以合成的移動方框模擬偵測結果，需要 Re-ID 時直接寫回正確 ID (理想 Re-ID)，
+ * 檢查追蹤沿用的 ID 是否正確，以及 Re-ID 的觸發次數。
+ */
+
+#include "test_common.h"
+#include "tracker.h"
+#include <algorithm>
+#include <string.h>
+
+// yolo_pose.cpp 依賴 TFLM，測試直接提供相同定義的 IoU
+float YoloPoseDetector::boxIou(const Box& a, const Box& b) {
+    float x1 = std::max(a.x, b.x);
+    float y1 = std::max(a.y, b.y);
+    float x2 = std::min(a.x + a.w, b.x + b.w);
+    float y2 = std::min(a.y + a.h, b.y + b.h);
+    float intersection = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+    float union_area = a.w * a.h + b.w * b.h - intersection;
+    if (union_area <= 0) return 0.0f;
+    return intersection / union_area;
+}
+
+static PersonDetection makeDetection(float x, float y) {
+    PersonDetection det;
+    memset(&det, 0, sizeof(det));
+    det.bbox.x = x;
+    det.bbox.y = y;
+    det.bbox.w = 40.0f;
+    det.bbox.h = 100.0f;
+    det.confidence = 0.9f;
+    return det;
+}
+
+// 一幀: 更新追蹤器、檢查沿用的 ID，需要時以正確 ID 模擬 Re-ID
+// 回傳本幀 Re-ID 次數
+static int runFrame(Tracker& tracker, const PersonDetection* dets, const int* truth,
+                    int count, uint32_t frame, TrackResult* results) {
+    int num_reid = tracker.update(dets, count, frame, results);
+    int counted = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i].needs_reid) {
+            tracker.setPersonId(results[i].track_id, truth[i], frame);
+            counted++;
+        } else {
+            TEST_CHECK_MSG(results[i].person_id == truth[i],
+                           "frame %u: detection %d tracked as %d, expected %d",
+                           (unsigned)frame, i, results[i].person_id, truth[i]);
+        }
+    }
+    TEST_CHECK(counted == num_reid);
+    return num_reid;
+}
+
+static void testCrossingKeepsIds() {
+    // 兩人水平交會 70 幀，偵測順序每幀交換，不能依賴索引
+    Tracker tracker;
+    TrackResult results[2];
+    int total_reid = 0;
+    int overlap_reid = 0;
+    const int frames = 70;
+    for (int f = 0; f < frames; f++) {
+        PersonDetection a = makeDetection(20.0f + f * 3.0f, 80.0f);
+        PersonDetection b = makeDetection(227.0f - f * 3.0f, 84.0f);
+        PersonDetection dets[2];
+        int truth[2];
+        int first = f & 1;
+        dets[first] = a;     truth[first] = 100;
+        dets[1 - first] = b; truth[1 - first] = 200;
+        
+        int num_reid = runFrame(tracker, dets, truth, 2, f, results);
+        total_reid += num_reid;
+        if (YoloPoseDetector::boxIou(a.bbox, b.bbox) > TRACKER_AMBIGUOUS_IOU) {
+            TEST_CHECK_MSG(num_reid == 2, "frame %d: overlapping detections not re-identified", f);
+            overlap_reid += num_reid;
+        }
+        TEST_CHECK(results[0].track_id != results[1].track_id);
+    }
+    
+    // 開頭各一次、交會期間每幀、每 TRACKER_REID_INTERVAL 幀重新驗證，其餘沿用
+    printf("  Re-ID: %d/%d detections (%d while overlapping)\n", total_reid, frames * 2, overlap_reid);
+    TEST_CHECK(overlap_reid > 0);
+    TEST_CHECK(total_reid <= 2 + overlap_reid + 2 * (frames / TRACKER_REID_INTERVAL));
+    TEST_CHECK(tracker.activeTracks() == 2);
+}
+
+static void testPeriodicRevalidation() {
+    Tracker tracker;
+    TrackResult result;
+    PersonDetection det = makeDetection(100.0f, 60.0f);
+    int truth = 7;
+    int total_reid = 0;
+    for (uint32_t f = 0; f < 100; f++) {
+        total_reid += runFrame(tracker, &det, &truth, 1, f, &result);
+    }
+    // 第 0、30、60、90 幀
+    TEST_CHECK(total_reid == (100 + TRACKER_REID_INTERVAL - 1) / TRACKER_REID_INTERVAL);
+}
+
+static void testMissedFrames() {
+    Tracker tracker;
+    TrackResult result;
+    PersonDetection det = makeDetection(100.0f, 60.0f);
+    int truth = 3;
+    uint32_t f = 0;
+    runFrame(tracker, &det, &truth, 1, f++, &result);
+    int track_id = result.track_id;
+    
+    // 短暫消失: 軌跡保留，重新出現時沿用 ID
+    for (int i = 0; i < TRACKER_MAX_MISSES; i++) tracker.update(nullptr, 0, f++, nullptr);
+    TEST_CHECK(tracker.activeTracks() == 1);
+    TEST_CHECK(runFrame(tracker, &det, &truth, 1, f++, &result) == 0);
+    TEST_CHECK(result.track_id == track_id);
+    
+    // 消失超過 TRACKER_MAX_MISSES 幀: 軌跡刪除，重新出現時為新軌跡並需要 Re-ID
+    for (int i = 0; i <= TRACKER_MAX_MISSES; i++) tracker.update(nullptr, 0, f++, nullptr);
+    TEST_CHECK(tracker.activeTracks() == 0);
+    TEST_CHECK(runFrame(tracker, &det, &truth, 1, f++, &result) == 1);
+    TEST_CHECK(result.track_id != track_id);
+}
+
+static void testEmptyFramesAgeTracks() {
+    // 與 analyzeFrame 相同: 沒有偵測的幀仍以 count = 0 呼叫 update()
+    Tracker tracker;
+    TrackResult results[YOLO_MAX_DETECTIONS];
+    PersonDetection dets[1];
+    int truth = 5;
+    uint32_t f = 0;
+    for (; f < 10; f++) {
+        dets[0] = makeDetection(40.0f + f * 4.0f, 60.0f);
+        runFrame(tracker, dets, &truth, 1, f, results);
+    }
+    int track_id = results[0].track_id;
+    
+    for (int i = 0; i < TRACKER_MAX_MISSES; i++) tracker.update(dets, 0, f++, results);
+    TEST_CHECK(tracker.activeTracks() == 1);
+    tracker.update(dets, 0, f++, results);
+    TEST_CHECK(tracker.activeTracks() == 0);
+    
+    // 在原軌跡的預測位置重新出現: 不可沿用舊軌跡的 ID，必須重新做 Re-ID
+    dets[0] = makeDetection(40.0f + f * 4.0f, 60.0f);
+    TEST_CHECK(runFrame(tracker, dets, &truth, 1, f, results) == 1);
+    TEST_CHECK(results[0].track_id != track_id);
+    TEST_CHECK(results[0].person_id == -1);
+}
+
+int main() {
+    TEST_RUN(testCrossingKeepsIds);
+    TEST_RUN(testPeriodicRevalidation);
+    TEST_RUN(testMissedFrames);
+    TEST_RUN(testEmptyFramesAgeTracks);
+    return TEST_RESULT();
+}